@@ -0,0 +1,608 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "Autopilot.h"
+
+using namespace Snake;
+
+std::unique_ptr<Autopilot> Autopilot::Create(Strategy strategy)
+{
+    switch (strategy)
+    {
+    case Strategy::Greedy:
+        return std::make_unique<GreedyAutopilot>();
+    case Strategy::AStar:
+        return std::make_unique<AStarAutopilot>();
+    case Strategy::Hamiltonian:
+        return std::make_unique<HamiltonianAutopilot>();
+    case Strategy::DistanceField:
+        return std::make_unique<DistanceFieldAutopilot>();
+    default:
+        throw std::invalid_argument("Invalid strategy");
+    }
+}
+
+std::string_view Autopilot::GetName(Strategy strategy)
+{
+    switch (strategy)
+    {
+    case Strategy::Greedy:
+        return "Greedy";
+    case Strategy::AStar:
+        return "A*";
+    case Strategy::Hamiltonian:
+        return "Hamiltonian";
+    case Strategy::DistanceField:
+        return "Distance field";
+    default:
+        throw std::invalid_argument("Invalid strategy");
+    }
+}
+
+std::string_view Autopilot::GetKey(Strategy strategy)
+{
+    switch (strategy)
+    {
+    case Strategy::Greedy:
+        return "greedy";
+    case Strategy::AStar:
+        return "astar";
+    case Strategy::Hamiltonian:
+        return "hamiltonian";
+    case Strategy::DistanceField:
+        return "field";
+    default:
+        throw std::invalid_argument("Invalid strategy");
+    }
+}
+
+std::optional<Autopilot::Strategy> Autopilot::ParseKey(std::string_view key)
+{
+    for (auto strategy : STRATEGIES)
+    {
+        if (GetKey(strategy) == key)
+        {
+            return strategy;
+        }
+    }
+    return std::nullopt;
+}
+
+GameEngine::Direction Autopilot::GetSafeDirection(const GameEngine& engine)
+{
+    /**
+     * Room is what can be reached from the cell, up to the length of the snake,
+     * so a pocket it would not fit in loses to open space. Cells free right
+     * around it break a tie.
+     */
+    const auto& board = engine.GetBoard();
+    Grid grid{engine};
+    auto head = engine.ToIndex(engine.GetSnake().front());
+    auto limit = static_cast<uint32_t>(std::min<size_t>(engine.GetSnake().size(), SAFE_ROOM_LIMIT));
+    auto safeDirection = engine.GetDirection();
+    std::optional<std::pair<uint32_t, uint32_t>> mostRoom{};
+    for (auto direction : Grid::DIRECTIONS)
+    {
+        if (direction == GameEngine::OppositeDirection(engine.GetDirection()))
+        {
+            continue;
+        }
+        auto next = grid.Neighbor(head, direction);
+        if (!board.IsFree(next))
+        {
+            continue;
+        }
+        uint32_t x = (next % grid.GetWidth() + grid.GetWidth() - 1) % grid.GetWidth();
+        uint32_t y = (next / grid.GetWidth() + grid.GetHeight() - 1) % grid.GetHeight();
+        std::pair room{board.CountReachable(next, limit), board.CountFree(x, y, 3, 3)};
+        if (!mostRoom.has_value() || room > mostRoom.value())
+        {
+            mostRoom = room;
+            safeDirection = direction;
+        }
+    }
+    return safeDirection;
+}
+
+void Autopilot::Reset(const GameEngine& engine)
+{
+    _path.clear();
+    _target = NO_CELL;
+    Grid grid{engine};
+    if (grid == _grid)
+    {
+        return;
+    }
+    _grid = grid;
+    _visited.assign(_grid.GetSize(), 0);
+    _stamp = 0;
+    _from.assign(_grid.GetSize(), Direction::Up);
+    _queue.clear();
+    _queue.reserve(std::min(_grid.GetSize(), SEARCH_BUDGET));
+}
+
+void Autopilot::NewSearch()
+{
+    if (++_stamp == 0)
+    {
+        /** Once every 4 billion searches */
+        std::fill(_visited.begin(), _visited.end(), 0);
+        _stamp = 1;
+    }
+}
+
+bool Autopilot::IsVisited(uint32_t cell) const
+{
+    return _visited[cell] == _stamp;
+}
+
+void Autopilot::Visit(uint32_t cell, Direction from)
+{
+    _visited[cell] = _stamp;
+    _from[cell] = from;
+}
+
+void Autopilot::TracePath(uint32_t start, uint32_t cell)
+{
+    _path.clear();
+    while (cell != start)
+    {
+        _path.push_back(cell);
+        cell = _grid.Neighbor(cell, GameEngine::OppositeDirection(_from[cell]));
+    }
+}
+
+std::optional<GameEngine::Direction> Autopilot::FollowPath(const GameEngine& engine)
+{
+    if (_path.empty())
+    {
+        return std::nullopt;
+    }
+    auto next = _path.back();
+    auto direction = _grid.ToDirection(engine.ToIndex(engine.GetSnake().front()), next);
+    if (!direction.has_value() || !Grid::IsFree(engine, next))
+    {
+        _path.clear();
+        return std::nullopt;
+    }
+    _path.pop_back();
+    return direction;
+}
+
+bool Autopilot::SearchPath(const GameEngine& engine, uint32_t goal, bool closest)
+{
+    auto head = engine.ToIndex(engine.GetSnake().front());
+    NewSearch();
+    Visit(head, engine.GetDirection());
+    _queue.clear();
+    _queue.push_back(head);
+    uint32_t closestCell = head;
+    uint32_t closestDistance = _grid.GetDistance(head, goal);
+    for (size_t i = 0; i < _queue.size() && i < SEARCH_BUDGET; i++)
+    {
+        auto cell = _queue[i];
+        for (auto direction : Grid::DIRECTIONS)
+        {
+            auto next = _grid.Neighbor(cell, direction);
+            /** A goal that is taken, like the tail, is only gone after the next step */
+            if (next == goal && (cell != head || Grid::IsFree(engine, goal)))
+            {
+                Visit(next, direction);
+                TracePath(head, next);
+                return true;
+            }
+            if (IsVisited(next) || !Grid::IsFree(engine, next))
+            {
+                continue;
+            }
+            Visit(next, direction);
+            _queue.push_back(next);
+            auto distance = _grid.GetDistance(next, goal);
+            if (distance < closestDistance)
+            {
+                closestDistance = distance;
+                closestCell = next;
+            }
+        }
+    }
+    if (!closest || closestCell == head)
+    {
+        return false;
+    }
+    TracePath(head, closestCell);
+    return true;
+}
+
+GameEngine::Direction GreedyAutopilot::Plan(const GameEngine& engine)
+{
+    auto food = engine.ToIndex(engine.GetFood());
+    if (food != _target)
+    {
+        _path.clear();
+        _target = food;
+    }
+    /** Cells on the plan stay free until the food is eaten, only the tail moves away */
+    auto direction = FollowPath(engine);
+    if (!direction.has_value() && SearchPath(engine, food, true))
+    {
+        direction = FollowPath(engine);
+    }
+    if (!direction.has_value())
+    {
+        return GetSafeDirection(engine);
+    }
+    return direction.value();
+}
+
+void AStarAutopilot::Reset(const GameEngine& engine)
+{
+    Autopilot::Reset(engine);
+    if (_cost.size() == _grid.GetSize())
+    {
+        return;
+    }
+    _cost.assign(_grid.GetSize(), 0);
+    _marks.assign(_grid.GetSize(), 0);
+    _markStamp = 0;
+    _open.clear();
+}
+
+GameEngine::Direction AStarAutopilot::Plan(const GameEngine& engine)
+{
+    auto food = engine.ToIndex(engine.GetFood());
+    if (food != _target)
+    {
+        _path.clear();
+        _target = food;
+    }
+    auto direction = FollowPath(engine);
+    if (direction.has_value())
+    {
+        return direction.value();
+    }
+    if (SearchFood(engine) && IsPlanSafe(engine))
+    {
+        direction = FollowPath(engine);
+        if (direction.has_value())
+        {
+            return direction.value();
+        }
+    }
+    /** No safe way to the food, follow the tail for a while and look again */
+    _path.clear();
+    auto tail = engine.ToIndex(engine.GetSnake().back());
+    if (SearchPath(engine, tail, false))
+    {
+        if (_path.size() > CHASE_STEPS)
+        {
+            _path.erase(_path.begin(), _path.end() - CHASE_STEPS);
+        }
+        direction = FollowPath(engine);
+        if (direction.has_value())
+        {
+            return direction.value();
+        }
+    }
+    return GetSafeDirection(engine);
+}
+
+bool AStarAutopilot::SearchFood(const GameEngine& engine)
+{
+    auto head = engine.ToIndex(engine.GetSnake().front());
+    auto food = _target;
+    /** Lowest estimate on top, the longer path first on a tie as it is closer to the food */
+    auto after = [](const Node& a, const Node& b){
+        return a.estimate > b.estimate || (a.estimate == b.estimate && a.cost < b.cost);
+    };
+    NewSearch();
+    Visit(head, engine.GetDirection());
+    _cost[head] = 0;
+    _open.clear();
+    _open.push_back({_grid.GetDistance(head, food), 0, head});
+    uint32_t closestCell = head;
+    uint32_t closestDistance = _grid.GetDistance(head, food);
+    uint32_t expanded = 0;
+    while (!_open.empty() && expanded < SEARCH_BUDGET)
+    {
+        std::pop_heap(_open.begin(), _open.end(), after);
+        auto node = _open.back();
+        _open.pop_back();
+        if (node.cost != _cost[node.cell])
+        {
+            /** A shorter way to it was found after it was queued */
+            continue;
+        }
+        if (node.cell == food)
+        {
+            TracePath(head, food);
+            return true;
+        }
+        expanded++;
+        for (auto direction : Grid::DIRECTIONS)
+        {
+            auto next = _grid.Neighbor(node.cell, direction);
+            if (!Grid::IsFree(engine, next))
+            {
+                continue;
+            }
+            auto cost = node.cost + 1;
+            if (IsVisited(next) && _cost[next] <= cost)
+            {
+                continue;
+            }
+            Visit(next, direction);
+            _cost[next] = cost;
+            auto distance = _grid.GetDistance(next, food);
+            _open.push_back({cost + distance, cost, next});
+            std::push_heap(_open.begin(), _open.end(), after);
+            if (distance < closestDistance)
+            {
+                closestDistance = distance;
+                closestCell = next;
+            }
+        }
+    }
+    if (closestCell == head)
+    {
+        return false;
+    }
+    TracePath(head, closestCell);
+    return true;
+}
+
+bool AStarAutopilot::IsPlanSafe(const GameEngine& engine)
+{
+    /**
+     * At the end of the plan the body is the plan, newest first,
+     * then the front of the snake as it is now. The rest of it is freed.
+     */
+    const auto& snake = engine.GetSnake();
+    size_t length = snake.size() + (_path.front() == _target ? 1 : 0);
+    size_t onPath = std::min(_path.size(), length);
+    size_t kept = length - onPath;
+    if (_markStamp >= UINT32_MAX - 2)
+    {
+        std::fill(_marks.begin(), _marks.end(), 0);
+        _markStamp = 0;
+    }
+    _markStamp += 2;
+    uint32_t taken = _markStamp;
+    uint32_t freed = _markStamp + 1;
+    for (size_t i = 0; i < onPath; i++)
+    {
+        _marks[_path[i]] = taken;
+    }
+    for (size_t i = kept; i < snake.size(); i++)
+    {
+        auto cell = engine.ToIndex(snake[i]);
+        if (_marks[cell] != taken)
+        {
+            _marks[cell] = freed;
+        }
+    }
+    auto isTaken = [&](uint32_t cell){
+        return _marks[cell] == taken || (_marks[cell] != freed && !Grid::IsFree(engine, cell));
+    };
+    auto head = _path.front();
+    auto tail = kept > 0 ? engine.ToIndex(snake[kept - 1]) : _path[onPath - 1];
+    NewSearch();
+    Visit(head, Direction::Up);
+    _queue.clear();
+    _queue.push_back(head);
+    for (size_t i = 0; i < _queue.size() && i < SEARCH_BUDGET; i++)
+    {
+        auto cell = _queue[i];
+        for (auto direction : Grid::DIRECTIONS)
+        {
+            auto next = _grid.Neighbor(cell, direction);
+            if (next == tail && cell != head)
+            {
+                return true;
+            }
+            if (IsVisited(next) || isTaken(next))
+            {
+                continue;
+            }
+            Visit(next, direction);
+            _queue.push_back(next);
+        }
+    }
+    /** Running out of budget means there is a lot of room */
+    return _queue.size() >= SEARCH_BUDGET;
+}
+
+void HamiltonianAutopilot::Reset(const GameEngine& engine)
+{
+    static_assert(DEFAULT_STRATEGY != Strategy::Hamiltonian);
+    Autopilot::Reset(engine);
+    if (engine.GetEdges() != Level::Edges::Wrap || engine.GetLevel()->GetWallCount() != 0)
+    {
+        if (!_fallback)
+        {
+            _fallback = Create(DEFAULT_STRATEGY);
+        }
+        _fallback->Reset(engine);
+        return;
+    }
+    _fallback.reset();
+    if (_cycleGrid != _grid)
+    {
+        BuildCycle();
+        _cycleGrid = _grid;
+    }
+}
+
+void HamiltonianAutopilot::BuildCycle()
+{
+    uint32_t width = _grid.GetWidth();
+    uint32_t height = _grid.GetHeight();
+    _order.assign(_grid.GetSize(), 0);
+    uint32_t position = 0;
+    auto add = [this, width, &position](uint32_t x, uint32_t y){
+        _order[x + y*width] = position++;
+    };
+    auto addRows = [width, &add](uint32_t rows){
+        for (uint32_t y = 0; y < rows; y++)
+        {
+            for (uint32_t i = 0; i < width; i++)
+            {
+                add(y % 2 == 0 ? i : width - 1 - i, y);
+            }
+        }
+    };
+    if (height % 2 == 0 || height == 1)
+    {
+        /**
+         * Right and left row by row, back up from the end of the last row.
+         * A single row is a cycle of its own, its end wraps around to its start.
+         */
+        addRows(height);
+    }
+    else if (width % 2 == 0)
+    {
+        /** The same column by column */
+        for (uint32_t x = 0; x < width; x++)
+        {
+            for (uint32_t i = 0; i < height; i++)
+            {
+                add(x, x % 2 == 0 ? i : height - 1 - i);
+            }
+        }
+    }
+    else
+    {
+        /**
+         * Both odd. Rows down to the last three, the first of those to the right,
+         * then up and down through the last two back to the first column.
+         * The last cell wraps around to the first.
+         */
+        addRows(height - 3);
+        for (uint32_t x = 0; x < width; x++)
+        {
+            add(x, height - 3);
+        }
+        for (uint32_t i = 0; i < width; i++)
+        {
+            uint32_t x = width - 1 - i;
+            add(x, i % 2 == 0 ? height - 2 : height - 1);
+            add(x, i % 2 == 0 ? height - 1 : height - 2);
+        }
+    }
+}
+
+uint32_t HamiltonianAutopilot::GetCycleDistance(uint32_t from, uint32_t to) const
+{
+    return (_order[to] + _grid.GetSize() - _order[from]) % _grid.GetSize();
+}
+
+GameEngine::Direction HamiltonianAutopilot::Plan(const GameEngine& engine)
+{
+    if (_fallback)
+    {
+        return _fallback->Plan(engine);
+    }
+    const auto& snake = engine.GetSnake();
+    auto head = engine.ToIndex(snake.front());
+    auto tail = engine.ToIndex(snake.back());
+    auto food = engine.ToIndex(engine.GetFood());
+    std::optional<Direction> planned{};
+    uint32_t furthest = 0;
+    for (auto direction : Grid::DIRECTIONS)
+    {
+        if (GetCycleDistance(head, _grid.Neighbor(head, direction)) == 1)
+        {
+            planned = direction;
+            furthest = 1;
+        }
+    }
+    if (snake.size() * SHORTCUT_FILL < _grid.GetSize())
+    {
+        /**
+         * The body is behind the head along the cycle, so the cells between
+         * the head and the tail are free. Jump ahead among those, but not past the food.
+         */
+        auto tailDistance = GetCycleDistance(head, tail);
+        auto foodDistance = GetCycleDistance(head, food);
+        for (auto direction : Grid::DIRECTIONS)
+        {
+            auto next = _grid.Neighbor(head, direction);
+            auto distance = GetCycleDistance(head, next);
+            if (Grid::IsFree(engine, next) &&
+                distance > furthest &&
+                distance <= foodDistance &&
+                distance + SHORTCUT_MARGIN < tailDistance)
+            {
+                planned = direction;
+                furthest = distance;
+            }
+        }
+    }
+    if (!planned.has_value() || !Grid::IsFree(engine, _grid.Neighbor(head, planned.value())))
+    {
+        /** Taken over in the middle of a game, the body is not on the cycle yet */
+        return GetSafeDirection(engine);
+    }
+    return planned.value();
+}
+
+void DistanceFieldAutopilot::Reset(const GameEngine& engine)
+{
+    Autopilot::Reset(engine);
+    _field.Reset(engine);
+    _head = engine.ToIndex(engine.GetSnake().front());
+    _tail = engine.ToIndex(engine.GetSnake().back());
+}
+
+GameEngine::Direction DistanceFieldAutopilot::Plan(const GameEngine& engine)
+{
+    auto head = engine.ToIndex(engine.GetSnake().front());
+    auto tail = engine.ToIndex(engine.GetSnake().back());
+    auto food = engine.ToIndex(engine.GetFood());
+    if (food != _field.GetFood() || !_grid.ToDirection(_head, head).has_value())
+    {
+        /** New food, or steps were missed */
+        _field.Reset(engine);
+    }
+    else
+    {
+        /** The head took a cell and the tail freed one */
+        _field.Touch(engine, head);
+        _field.Touch(engine, _tail);
+    }
+    _head = head;
+    _tail = tail;
+    std::optional<Direction> direction{};
+    if (_field.Update(engine, REBUILD_BUDGET))
+    {
+        direction = _field.Descend(engine);
+        if (!direction.has_value())
+        {
+            /** The food is walled off, keep close to the tail until it opens up */
+            _path.clear();
+            if (SearchPath(engine, tail, false))
+            {
+                direction = FollowPath(engine);
+            }
+            _path.clear();
+        }
+    }
+    else
+    {
+        /** Head for the food the greedy way until the rebuild is done */
+        if (food != _target)
+        {
+            _path.clear();
+            _target = food;
+        }
+        direction = FollowPath(engine);
+        if (!direction.has_value() && SearchPath(engine, food, true))
+        {
+            direction = FollowPath(engine);
+        }
+    }
+    if (!direction.has_value())
+    {
+        return GetSafeDirection(engine);
+    }
+    return direction.value();
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "GameEngine.h"
+#include "Grid.h"
+#include "DistanceField.h"
+
+namespace Snake
+{
+    /**
+     * @brief Steers the snake instead of the arrow keys.
+     *      Search buffers are sized with the board and reused, and a search
+     *      looks at no more than SEARCH_BUDGET cells, so a tick costs about
+     *      the same on any board.
+     */
+    class Autopilot
+    {
+    public:
+        enum class Strategy : uint8_t
+        {
+            /** Shortest path to the food */
+            Greedy,
+            /** Shortest path to the food, if the tail can still be reached at its end */
+            AStar,
+            /**
+             * Follow a cycle through every cell, cutting across while the snake is short.
+             * The cycle needs an open board that wraps, other levels are played by DEFAULT_STRATEGY.
+             */
+            Hamiltonian,
+            /** Shortest path to the food from a distance field kept up to date */
+            DistanceField,
+        };
+        static constexpr Strategy STRATEGIES[] = {
+            Strategy::Greedy,
+            Strategy::AStar,
+            Strategy::Hamiltonian,
+            Strategy::DistanceField,
+        };
+        static constexpr Strategy DEFAULT_STRATEGY = Strategy::DistanceField;
+
+        static std::unique_ptr<Autopilot> Create(Strategy strategy);
+        static std::string_view GetName(Strategy strategy);
+        /** How the strategy is written in the settings file */
+        static std::string_view GetKey(Strategy strategy);
+        static std::optional<Strategy> ParseKey(std::string_view key);
+        /**
+         * @brief A direction that does not crash on the next step,
+         *      towards the cell with the most room to reach from it.
+         *      The current direction if there is none.
+         */
+        static GameEngine::Direction GetSafeDirection(const GameEngine& engine);
+
+        virtual ~Autopilot() = default;
+
+        Autopilot(const Autopilot& other) = delete;
+        Autopilot& operator=(const Autopilot& other) = delete;
+        Autopilot(Autopilot&& other) noexcept = delete;
+        Autopilot& operator=(Autopilot&& other) noexcept = delete;
+
+        /**
+         * @brief Forget the plan, the game was replaced or taken back.
+         *      Buffers are only sized again when the board size changes.
+         *
+         * @param engine
+         */
+        virtual void Reset(const GameEngine& engine);
+        /**
+         * @brief Choose the direction of the next step.
+         *
+         * @param engine An unfinished game, the one given to Reset.
+         */
+        virtual GameEngine::Direction Plan(const GameEngine& engine) = 0;
+
+    protected:
+        typedef GameEngine::Direction Direction;
+
+        /** Cells one search may look at */
+        static constexpr uint32_t SEARCH_BUDGET = 1 << 15;
+        /** Room GetSafeDirection tells apart, more is as good as open space */
+        static constexpr uint32_t SAFE_ROOM_LIMIT = 1 << 10;
+        static constexpr uint32_t NO_CELL = UINT32_MAX;
+
+        Autopilot() = default;
+
+        Grid _grid{};
+        /** The cells of the plan, the next one last */
+        std::vector<uint32_t> _path{};
+        /** The food the plan was made for */
+        uint32_t _target{NO_CELL};
+        /** Search buffers */
+        std::vector<uint32_t> _queue{};
+        /** The direction each visited cell was entered with */
+        std::vector<Direction> _from{};
+
+        /** Forget the cells visited by the last search */
+        void NewSearch();
+        bool IsVisited(uint32_t cell) const;
+        void Visit(uint32_t cell, Direction from);
+        /** Make the path from start to a visited cell the plan */
+        void TracePath(uint32_t start, uint32_t cell);
+        /**
+         * @brief Take the next step of the plan.
+         *
+         * @return nothing if there is no plan or it is blocked.
+         */
+        std::optional<Direction> FollowPath(const GameEngine& engine);
+        /**
+         * @brief Plan a breadth first path from the head.
+         *
+         * @param goal Accepted as the end of the path even if it is not free.
+         * @param closest Without the goal in reach, end at the cell found closest to it.
+         * @return false if there is no step to take.
+         */
+        bool SearchPath(const GameEngine& engine, uint32_t goal, bool closest);
+
+    private:
+        /** Visited cells carry the current stamp, so nothing is cleared between searches */
+        std::vector<uint32_t> _visited{};
+        uint32_t _stamp{0};
+    };
+
+    class GreedyAutopilot : public Autopilot
+    {
+    public:
+        GreedyAutopilot() = default;
+        ~GreedyAutopilot() override = default;
+        Direction Plan(const GameEngine& engine) override;
+    };
+
+    class AStarAutopilot : public Autopilot
+    {
+    public:
+        AStarAutopilot() = default;
+        ~AStarAutopilot() override = default;
+        void Reset(const GameEngine& engine) override;
+        Direction Plan(const GameEngine& engine) override;
+
+    private:
+        /** Steps towards the tail before looking for a safe way to the food again */
+        static constexpr size_t CHASE_STEPS = 8;
+
+        struct Node
+        {
+            /** Cost so far plus the distance left */
+            uint32_t estimate;
+            uint32_t cost;
+            uint32_t cell;
+        };
+
+        /** Open nodes, a heap with the lowest estimate on top */
+        std::vector<Node> _open{};
+        std::vector<uint32_t> _cost{};
+        /**
+         * Cells of the snake as it would be at the end of the plan.
+         * Marked with _markStamp if taken and _markStamp + 1 if freed.
+         */
+        std::vector<uint32_t> _marks{};
+        uint32_t _markStamp{0};
+
+        /** Plan a path to the food, or towards it if it is out of reach */
+        bool SearchFood(const GameEngine& engine);
+        /** Whether the tail can be reached once the snake is at the end of the plan */
+        bool IsPlanSafe(const GameEngine& engine);
+    };
+
+    class HamiltonianAutopilot : public Autopilot
+    {
+    public:
+        HamiltonianAutopilot() = default;
+        ~HamiltonianAutopilot() override = default;
+        void Reset(const GameEngine& engine) override;
+        Direction Plan(const GameEngine& engine) override;
+
+    private:
+        /** Only cut across while the snake takes less than 1/SHORTCUT_FILL of the board */
+        static constexpr uint32_t SHORTCUT_FILL = 2;
+        /** Cells to leave free in front of the tail after cutting across */
+        static constexpr uint32_t SHORTCUT_MARGIN = 4;
+
+        /** The position of each cell along the cycle */
+        std::vector<uint32_t> _order{};
+        /** The board the cycle was built for, a board of the same size may be laid out otherwise */
+        Grid _cycleGrid{};
+        /** Plays a level with walls or solid edges, which the cycle would run into */
+        std::unique_ptr<Autopilot> _fallback{};
+
+        void BuildCycle();
+        /** Steps along the cycle from one cell to the other */
+        uint32_t GetCycleDistance(uint32_t from, uint32_t to) const;
+    };
+
+    class DistanceFieldAutopilot : public Autopilot
+    {
+    public:
+        DistanceFieldAutopilot() = default;
+        ~DistanceFieldAutopilot() override = default;
+        void Reset(const GameEngine& engine) override;
+        Direction Plan(const GameEngine& engine) override;
+
+    private:
+        /** Cells the rebuild for new food may visit in one tick */
+        static constexpr uint32_t REBUILD_BUDGET = 1 << 14;
+
+        DistanceField _field{};
+        /** Where the snake was at the last plan */
+        uint32_t _head{NO_CELL};
+        uint32_t _tail{NO_CELL};
+    };
+}
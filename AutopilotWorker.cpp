@@ -0,0 +1,225 @@
+#include "AutopilotWorker.h"
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <stdexcept>
+
+using namespace Snake;
+
+AutopilotWorker::AutopilotWorker(Tev& tev)
+    : _tev(tev)
+{
+    _eventFd = eventfd(0, EFD_NONBLOCK);
+    if (_eventFd == -1)
+    {
+        throw std::runtime_error("eventfd failed");
+    }
+    _readHandler = _tev.SetReadHandler(_eventFd, [this](){
+        eventfd_t value = 0;
+        int rc = eventfd_read(_eventFd, &value);
+        if (rc != 0)
+        {
+            throw std::runtime_error("eventfd_read failed");
+        }
+        Receive();
+    });
+    _thread = std::thread(&AutopilotWorker::WorkerThread, this);
+}
+
+AutopilotWorker::~AutopilotWorker()
+{
+    _stopping.store(true, std::memory_order_release);
+    _requested.fetch_add(1, std::memory_order_release);
+    _requested.notify_one();
+    _thread.join();
+    _readHandler.Clear();
+    close(_eventFd);
+}
+
+void AutopilotWorker::Reset(Autopilot::Strategy strategy, const GameEngine& engine)
+{
+    _generation++;
+    _strategy = strategy;
+    _planning = true;
+    _plan.reset();
+    Request request{};
+    request.type = RequestType::Reset;
+    request.generation = _generation;
+    request.strategy = strategy;
+    request.engine = std::make_unique<GameEngine>(engine);
+    _lost = !Send(std::move(request));
+}
+
+void AutopilotWorker::Stop()
+{
+    if (!_planning)
+    {
+        return;
+    }
+    _planning = false;
+    _generation++;
+    _plan.reset();
+    Request request{};
+    request.type = RequestType::Stop;
+    request.generation = _generation;
+    /** If it does not fit, the plans for the old generation are dropped anyway */
+    Send(std::move(request));
+}
+
+void AutopilotWorker::Step(const GameEngine& engine, const GameEngine::TickDelta& delta)
+{
+    if (!_planning)
+    {
+        return;
+    }
+    if (_lost)
+    {
+        if (!engine.IsFinished())
+        {
+            Reset(_strategy, engine);
+        }
+        return;
+    }
+    Request request{};
+    request.type = RequestType::Step;
+    request.generation = _generation;
+    request.delta = delta;
+    _lost = !Send(std::move(request));
+}
+
+void AutopilotWorker::Undo(const GameEngine& engine, const GameEngine::TickDelta& delta)
+{
+    if (!_planning)
+    {
+        return;
+    }
+    if (_lost)
+    {
+        Reset(_strategy, engine);
+        return;
+    }
+    Request request{};
+    request.type = RequestType::Undo;
+    request.generation = _generation;
+    request.delta = delta;
+    _lost = !Send(std::move(request));
+}
+
+GameEngine::Direction AutopilotWorker::Take(const GameEngine& engine)
+{
+    Receive();
+    if (_plan.has_value() && _plan->tick == engine.GetTick())
+    {
+        auto direction = _plan->direction;
+        _plan.reset();
+        return direction;
+    }
+    _misses++;
+    return Autopilot::GetSafeDirection(engine);
+}
+
+uint32_t AutopilotWorker::GetMisses() const
+{
+    return _misses;
+}
+
+bool AutopilotWorker::Send(Request&& request)
+{
+    if (!_requests.TryPush(std::move(request)))
+    {
+        return false;
+    }
+    _requested.fetch_add(1, std::memory_order_release);
+    _requested.notify_one();
+    return true;
+}
+
+void AutopilotWorker::Receive()
+{
+    Response response{};
+    while (_responses.TryPop(response))
+    {
+        if (response.generation == _generation)
+        {
+            _plan = response;
+        }
+    }
+}
+
+void AutopilotWorker::WorkerThread()
+{
+    uint32_t requested = 0;
+    while (true)
+    {
+        _requested.wait(requested, std::memory_order_acquire);
+        if (_stopping.load(std::memory_order_acquire))
+        {
+            return;
+        }
+        requested = _requested.load(std::memory_order_acquire);
+        /** Catch up with the game first, only its latest state is worth a plan */
+        Request request{};
+        bool changed = false;
+        while (_requests.TryPop(request))
+        {
+            Handle(request);
+            changed = true;
+        }
+        if (!changed || _engine == nullptr || _engine->IsFinished())
+        {
+            continue;
+        }
+        Response response{};
+        response.generation = _workerGeneration;
+        response.tick = _engine->GetTick();
+        response.direction = _autopilot->Plan(*_engine);
+        if (_responses.TryPush(std::move(response)))
+        {
+            eventfd_write(_eventFd, 1);
+        }
+    }
+}
+
+void AutopilotWorker::Handle(Request& request)
+{
+    if (request.type == RequestType::Reset)
+    {
+        _workerGeneration = request.generation;
+        _engine = std::move(request.engine);
+        /** The same strategy keeps its buffers */
+        if (_autopilot == nullptr || _workerStrategy != request.strategy)
+        {
+            _workerStrategy = request.strategy;
+            _autopilot = Autopilot::Create(request.strategy);
+        }
+        _autopilot->Reset(*_engine);
+        return;
+    }
+    if (request.type == RequestType::Stop)
+    {
+        _workerGeneration = request.generation;
+        _engine.reset();
+        return;
+    }
+    if (request.generation != _workerGeneration || _engine == nullptr)
+    {
+        return;
+    }
+    try
+    {
+        if (request.type == RequestType::Step)
+        {
+            _engine->Redo(request.delta);
+        }
+        else
+        {
+            _engine->Undo(request.delta);
+            /** The plan was for a later point of the game */
+            _autopilot->Reset(*_engine);
+        }
+    }
+    catch (const std::logic_error&)
+    {
+        /** Out of step with the game, plan nothing until the next reset */
+        _engine.reset();
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <tev-cpp/Tev.h>
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+#include "GameEngine.h"
+#include "Autopilot.h"
+#include "SpscRing.h"
+
+namespace Snake
+{
+    /**
+     * @brief Runs an autopilot on its own thread, so planning never holds up the event loop.
+     *      The worker keeps a copy of the game that follows the steps sent to it,
+     *      and plans the next direction as soon as it has caught up.
+     *      Both ways go through lock-free rings, an eventfd wakes the loop for the answers.
+     */
+    class AutopilotWorker
+    {
+    public:
+        AutopilotWorker(Tev& tev);
+        ~AutopilotWorker();
+
+        AutopilotWorker(const AutopilotWorker& other) = delete;
+        AutopilotWorker& operator=(const AutopilotWorker& other) = delete;
+        AutopilotWorker(AutopilotWorker&& other) noexcept = delete;
+        AutopilotWorker& operator=(AutopilotWorker&& other) noexcept = delete;
+
+        /**
+         * @brief Start planning a game with a strategy.
+         *      The game is copied, earlier plans are dropped.
+         *
+         * @param strategy
+         * @param engine An unfinished game.
+         */
+        void Reset(Autopilot::Strategy strategy, const GameEngine& engine);
+        /** Stop planning until the next Reset */
+        void Stop();
+        /**
+         * @brief The game took a step.
+         *
+         * @param engine The game after the step.
+         * @param delta
+         */
+        void Step(const GameEngine& engine, const GameEngine::TickDelta& delta);
+        /**
+         * @brief The game took a step back.
+         *
+         * @param engine The game after the step back.
+         * @param delta
+         */
+        void Undo(const GameEngine& engine, const GameEngine::TickDelta& delta);
+        /**
+         * @brief The direction planned for the next step of the game.
+         *      If the plan is not ready, a safe direction is taken and counted as a miss.
+         *
+         * @param engine The game given to Reset, with every step since.
+         */
+        GameEngine::Direction Take(const GameEngine& engine);
+        /** Steps the plan was not ready for, since the worker was made */
+        uint32_t GetMisses() const;
+
+    private:
+        /** Steps the worker can fall behind before the game is sent again */
+        static constexpr size_t REQUEST_CAPACITY = 256;
+        static constexpr size_t RESPONSE_CAPACITY = 16;
+
+        enum class RequestType : uint8_t
+        {
+            Reset,
+            Stop,
+            Step,
+            Undo,
+        };
+        struct Request
+        {
+            RequestType type{RequestType::Stop};
+            /** Plans for another game are told apart by the generation */
+            uint32_t generation{0};
+            Autopilot::Strategy strategy{Autopilot::DEFAULT_STRATEGY};
+            /** Only for a reset */
+            std::unique_ptr<GameEngine> engine{};
+            GameEngine::TickDelta delta{};
+        };
+        struct Response
+        {
+            uint32_t generation{0};
+            /** The tick of the game the plan is for */
+            uint32_t tick{0};
+            GameEngine::Direction direction{GameEngine::Direction::Right};
+        };
+
+        Tev& _tev;
+        int _eventFd{-1};
+        Tev::FdHandler _readHandler{};
+        uint32_t _generation{0};
+        Autopilot::Strategy _strategy{Autopilot::DEFAULT_STRATEGY};
+        bool _planning{false};
+        /** A step did not fit in the ring, the game is sent again with the next one */
+        bool _lost{false};
+        std::optional<Response> _plan{};
+        uint32_t _misses{0};
+
+        /** Shared with the worker thread */
+        SpscRing<Request, REQUEST_CAPACITY> _requests{};
+        SpscRing<Response, RESPONSE_CAPACITY> _responses{};
+        /** Counts requests, the worker waits for it to change */
+        std::atomic<uint32_t> _requested{0};
+        std::atomic<bool> _stopping{false};
+        std::thread _thread{};
+
+        /** Worker side */
+        std::unique_ptr<GameEngine> _engine{};
+        std::unique_ptr<Autopilot> _autopilot{};
+        Autopilot::Strategy _workerStrategy{Autopilot::DEFAULT_STRATEGY};
+        uint32_t _workerGeneration{0};
+
+        /** Hand a request to the worker, false if the ring is full */
+        bool Send(Request&& request);
+        /** Keep the newest plan for the current game */
+        void Receive();
+        void WorkerThread();
+        /** Apply a request to the copy of the game */
+        void Handle(Request& request);
+    };
+}
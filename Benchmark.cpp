@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <optional>
+#include <utility>
+#include "Benchmark.h"
+#include "Autopilot.h"
+#include "Bitboard.h"
+#include "DistanceField.h"
+#include "GameEngine.h"
+#include "Grid.h"
+#include "VecEnv.h"
+#include "Replay.h"
+#include "Checkpointer.h"
+#include "BinaryIO.h"
+#include "Constants.h"
+
+using namespace Snake;
+
+namespace
+{
+    constexpr int BOARD_WIDTH = (Constants::DISPLAY_WIDTH - 2)/2;
+    constexpr int BOARD_HEIGHT = Constants::DISPLAY_HEIGHT - 3;
+    constexpr uint32_t TICKS = 2000000;
+    /** The standard board, and the largest, whose checkpoints used to grow with it */
+    constexpr std::pair<int, int> CHECKPOINT_SIZES[] = {{BOARD_WIDTH, BOARD_HEIGHT}, {GameEngine::MAX_SIZE, GameEngine::MAX_SIZE}};
+    /** Nanoseconds a capture may take on average, the frame loop waits for it */
+    constexpr double CHECKPOINT_BUDGET = 5000;
+    constexpr int PATHFINDING_SIZES[] = {64, 128, 256};
+    constexpr uint32_t PATHFINDING_TICKS = 2000;
+    constexpr size_t BATCH_GAMES = 256;
+    constexpr uint32_t BATCH_STEPS = 4000;
+    /** A batch step turns one game in this many, going straight never crashes a short snake */
+    constexpr uint32_t BATCH_TURN_ODDS = 8;
+    constexpr uint32_t ROOM_SIZE = 256;
+    /** Percent of the board taken, below the point where free cells stop being connected */
+    constexpr uint32_t ROOM_TAKEN = 35;
+    constexpr uint32_t ROOM_LIMIT = 1024;
+    constexpr uint32_t ROOM_CHECKS = 20000;
+
+    /** The same actions for both runs of the batch benchmark */
+    std::vector<VecEnv::Action> MakeActions(uint32_t step)
+    {
+        Random random{step};
+        std::vector<VecEnv::Action> actions(BATCH_GAMES);
+        for (auto& action : actions)
+        {
+            action = random.Below(BATCH_TURN_ODDS) == 0
+                ? static_cast<VecEnv::Action>(random.Below(4))
+                : static_cast<VecEnv::Action>(GameEngine::Direction::Right);
+        }
+        return actions;
+    }
+
+    /** Head for the food, but do not run into anything that is next to the head */
+    GameEngine::Direction Steer(const GameEngine& engine)
+    {
+        auto head = engine.GetSnake().front();
+        auto food = engine.GetFood();
+        int width = engine.GetWidth();
+        int height = engine.GetHeight();
+        auto horizontal = food.x > head.x ? GameEngine::Direction::Right : GameEngine::Direction::Left;
+        auto vertical = food.y > head.y ? GameEngine::Direction::Down : GameEngine::Direction::Up;
+        /** Once in the column of the food go straight for it, not left and right on the way */
+        if (food.x == head.x)
+        {
+            std::swap(horizontal, vertical);
+        }
+        GameEngine::Direction preferred[] = {
+            horizontal,
+            vertical,
+            GameEngine::OppositeDirection(horizontal),
+            GameEngine::OppositeDirection(vertical),
+        };
+        for (auto direction : preferred)
+        {
+            if (direction == GameEngine::OppositeDirection(engine.GetDirection()))
+            {
+                continue;
+            }
+            auto next = head;
+            switch (direction)
+            {
+            case GameEngine::Direction::Up:
+                next.y = (head.y - 1 + height) % height;
+                break;
+            case GameEngine::Direction::Down:
+                next.y = (head.y + 1) % height;
+                break;
+            case GameEngine::Direction::Left:
+                next.x = (head.x - 1 + width) % width;
+                break;
+            case GameEngine::Direction::Right:
+                next.x = (head.x + 1) % width;
+                break;
+            }
+            auto cell = engine.GetCell(next);
+            if (cell == GameEngine::CellType::Empty || cell == GameEngine::CellType::Food)
+            {
+                return direction;
+            }
+        }
+        return engine.GetDirection();
+    }
+
+    /**
+     * @brief Play games back to back for a number of ticks.
+     * 
+     * @param onTick Called after every tick that did not end the game.
+     * @return double Nanoseconds per tick.
+     */
+    template <typename F>
+    double Play(int width, int height, uint32_t ticks, F onTick)
+    {
+        GameEngine engine{width, height};
+        uint64_t seed = 0;
+        engine.Reset(seed);
+        Replay replay{seed, Level::Open(width, height)};
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < ticks; i++)
+        {
+            auto previousDirection = engine.GetDirection();
+            engine.SetDirection(Steer(engine));
+            engine.Step();
+            replay.Record(engine, previousDirection);
+            if (engine.IsFinished())
+            {
+                engine.Reset(++seed);
+                replay = Replay{seed, Level::Open(width, height)};
+                continue;
+            }
+            onTick(engine, replay);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / ticks;
+    }
+
+    struct FieldRun
+    {
+        uint32_t ticks;
+        std::chrono::nanoseconds total;
+        std::chrono::nanoseconds worst;
+        /** Folds in every direction taken, equal runs made the same moves */
+        uint64_t moves;
+    };
+
+    /**
+     * @brief Play one game down a distance field.
+     *
+     * @param incremental Keep the field up to date instead of rebuilding it every tick.
+     */
+    FieldRun FollowField(int size, bool incremental)
+    {
+        GameEngine engine{size, size};
+        engine.Reset(0);
+        DistanceField field{};
+        field.Reset(engine);
+        auto tail = engine.ToIndex(engine.GetSnake().back());
+        FieldRun run{};
+        for (; run.ticks < PATHFINDING_TICKS && !engine.IsFinished(); run.ticks++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            if (!incremental || engine.ToIndex(engine.GetFood()) != field.GetFood())
+            {
+                field.Reset(engine);
+            }
+            else
+            {
+                field.Touch(engine, engine.ToIndex(engine.GetSnake().front()));
+                field.Touch(engine, tail);
+            }
+            field.Update(engine, UINT32_MAX);
+            auto direction = field.Descend(engine);
+            if (!direction.has_value())
+            {
+                direction = Autopilot::GetSafeDirection(engine);
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            run.total += elapsed;
+            run.worst = std::max<std::chrono::nanoseconds>(run.worst, elapsed);
+            run.moves = run.moves*31 + static_cast<uint64_t>(direction.value()) + 1;
+            tail = engine.ToIndex(engine.GetSnake().back());
+            engine.SetDirection(direction.value());
+            engine.Step();
+        }
+        return run;
+    }
+
+    /** Bitboard::CountReachable the way it was done before, breadth first over a byte per cell */
+    uint32_t CountReachableByCell(const std::vector<uint8_t>& taken, const Grid& grid,
+        uint32_t from, uint32_t limit, std::vector<uint32_t>& queue, std::vector<uint32_t>& visited, uint32_t stamp)
+    {
+        uint32_t window = Bitboard::WINDOW;
+        uint32_t left = (from % grid.GetWidth() + grid.GetWidth() - window/2) % grid.GetWidth();
+        uint32_t top = (from / grid.GetWidth() + grid.GetHeight() - window/2) % grid.GetHeight();
+        auto inWindow = [&](uint32_t cell){
+            return (cell % grid.GetWidth() + grid.GetWidth() - left) % grid.GetWidth() < window &&
+                (cell / grid.GetWidth() + grid.GetHeight() - top) % grid.GetHeight() < window;
+        };
+        queue.clear();
+        queue.push_back(from);
+        visited[from] = stamp;
+        uint32_t count = taken[from] == 0 ? 1 : 0;
+        for (size_t i = 0; i < queue.size() && count < limit; i++)
+        {
+            for (auto direction : Grid::DIRECTIONS)
+            {
+                auto next = grid.Neighbor(queue[i], direction);
+                if (visited[next] == stamp || taken[next] != 0 || !inWindow(next))
+                {
+                    continue;
+                }
+                visited[next] = stamp;
+                queue.push_back(next);
+                count++;
+            }
+        }
+        return std::min(count, limit);
+    }
+}
+
+bool Benchmark::Run(std::ostream& output)
+{
+    output << std::fixed << std::setprecision(1);
+    bool withinBudget = Checkpoint(output);
+    Pathfinding(output);
+    Batch(output);
+    Room(output);
+    return withinBudget;
+}
+
+bool Benchmark::Checkpoint(std::ostream& output)
+{
+    bool withinBudget = true;
+    for (auto [width, height] : CHECKPOINT_SIZES)
+    {
+        output << "Checkpoint every " << Constants::CHECKPOINT_INTERVAL << " ticks, "
+            << width << "x" << height << " board, " << TICKS << " ticks" << std::endl;
+        double baseline = Play(width, height, TICKS, [](const GameEngine&, const Replay&){});
+        auto path = std::filesystem::temp_directory_path() / "snake-checkpoint-benchmark.bin";
+        Checkpointer::Statistics statistics{};
+        double withCheckpoints = 0;
+        {
+            Checkpointer checkpointer{path};
+            Checkpointer::Writer header = [level = Level::Open(width, height)](std::ostream& stream){
+                level.Write(stream);
+            };
+            std::optional<uint64_t> seed{};
+            size_t logged = 0;
+            withCheckpoints = Play(width, height, TICKS, [&](const GameEngine& engine, const Replay& replay){
+                if (seed != replay.seed)
+                {
+                    /** A new game, with a new log */
+                    checkpointer.SetHeader(header);
+                    seed = replay.seed;
+                    logged = 0;
+                }
+                if (engine.GetTick() % Constants::CHECKPOINT_INTERVAL == 0)
+                {
+                    /** What a ranked game and what any other game saves, more than either one */
+                    checkpointer.Capture([&](std::ostream& stream){
+                        BinaryIO::Write(stream, replay.seed);
+                        BinaryIO::Write(stream, replay.ticks);
+                        BinaryIO::Write(stream, static_cast<uint32_t>(replay.turns.size()));
+                        engine.WriteSnapshot(stream);
+                    }, [&](std::ostream& stream){
+                        replay.WriteTurns(stream, logged);
+                        logged = replay.turns.size();
+                    });
+                }
+            });
+            statistics = checkpointer.GetStatistics();
+            checkpointer.Remove();
+        }
+        auto nanoseconds = [](std::chrono::nanoseconds duration){
+            return static_cast<double>(duration.count());
+        };
+        double average = statistics.captures == 0 ? 0 : nanoseconds(statistics.captureTime) / statistics.captures;
+        output << "  tick without checkpoints: " << baseline << " ns" << std::endl;
+        output << "  tick with checkpoints:    " << withCheckpoints << " ns" << std::endl;
+        output << "  capture: " << statistics.captures << " taken, " << statistics.skipped << " skipped, "
+            << average << " ns average, " << nanoseconds(statistics.maxCaptureTime) << " ns max, "
+            << (average <= CHECKPOINT_BUDGET ? "within" : "OVER") << " the " << CHECKPOINT_BUDGET << " ns budget" << std::endl;
+        output << "  capture cost per tick: " << nanoseconds(statistics.captureTime) / TICKS << " ns" << std::endl;
+        withinBudget = withinBudget && average <= CHECKPOINT_BUDGET;
+    }
+    return withinBudget;
+}
+
+void Benchmark::Pathfinding(std::ostream& output)
+{
+    output << "Distance field, " << PATHFINDING_TICKS << " ticks per board" << std::endl;
+    for (auto size : PATHFINDING_SIZES)
+    {
+        auto rebuilt = FollowField(size, false);
+        auto incremental = FollowField(size, true);
+        auto microseconds = [](std::chrono::nanoseconds duration){
+            return static_cast<double>(duration.count()) / 1000;
+        };
+        output << "  " << size << "x" << size << ": rebuilt every tick "
+            << microseconds(rebuilt.total) / rebuilt.ticks << " us, "
+            << microseconds(rebuilt.worst) << " us max; incremental "
+            << microseconds(incremental.total) / incremental.ticks << " us, "
+            << microseconds(incremental.worst) << " us max; "
+            << (rebuilt.moves == incremental.moves && rebuilt.ticks == incremental.ticks ? "same moves" : "MOVES DIFFER")
+            << std::endl;
+    }
+}
+
+void Benchmark::Batch(std::ostream& output)
+{
+    output << "Batched environment, " << BATCH_GAMES << " games, "
+        << BOARD_WIDTH << "x" << BOARD_HEIGHT << " board, " << BATCH_STEPS << " steps" << std::endl;
+    std::vector<std::vector<VecEnv::Action>> actions{};
+    for (uint32_t step = 0; step < BATCH_STEPS; step++)
+    {
+        actions.push_back(MakeActions(step));
+    }
+    auto perSecond = [](std::chrono::steady_clock::duration elapsed){
+        return BATCH_GAMES * BATCH_STEPS / std::chrono::duration<double>(elapsed).count();
+    };
+
+    std::vector<GameEngine> engines(BATCH_GAMES, GameEngine{BOARD_WIDTH, BOARD_HEIGHT});
+    auto start = std::chrono::steady_clock::now();
+    for (size_t game = 0; game < BATCH_GAMES; game++)
+    {
+        engines[game].Reset(game);
+    }
+    for (const auto& stepActions : actions)
+    {
+        for (size_t game = 0; game < BATCH_GAMES; game++)
+        {
+            auto& engine = engines[game];
+            engine.SetDirection(static_cast<GameEngine::Direction>(stepActions[game]));
+            engine.Step();
+            if (engine.IsFinished())
+            {
+                engine.Reset(game);
+            }
+        }
+    }
+    auto enginesElapsed = std::chrono::steady_clock::now() - start;
+
+    std::vector<uint8_t> observations(VecEnv::GetObservationSize(BATCH_GAMES, BOARD_WIDTH, BOARD_HEIGHT));
+    std::vector<float> rewards(BATCH_GAMES);
+    std::vector<uint8_t> dones(BATCH_GAMES);
+    start = std::chrono::steady_clock::now();
+    VecEnv env{BATCH_GAMES, BOARD_WIDTH, BOARD_HEIGHT, 0, observations};
+    for (const auto& stepActions : actions)
+    {
+        env.Step(stepActions, rewards, dones);
+    }
+    auto envElapsed = std::chrono::steady_clock::now() - start;
+
+    output << "  GameEngine: " << perSecond(enginesElapsed) / 1e6 << " M steps/s" << std::endl;
+    output << "  VecEnv:     " << perSecond(envElapsed) / 1e6 << " M steps/s" << std::endl;
+}
+
+void Benchmark::Room(std::ostream& output)
+{
+    output << "Room checks, " << ROOM_SIZE << "x" << ROOM_SIZE << " board " << ROOM_TAKEN << "% taken, "
+        << ROOM_CHECKS << " checks of up to " << ROOM_LIMIT << " cells" << std::endl;
+    Random random{0};
+    Grid grid{ROOM_SIZE, ROOM_SIZE, true};
+    Bitboard board{};
+    board.Reset(ROOM_SIZE, ROOM_SIZE, true);
+    std::vector<uint8_t> taken(grid.GetSize(), 0);
+    for (uint32_t cell = 0; cell < grid.GetSize(); cell++)
+    {
+        if (random.Below(100) < ROOM_TAKEN)
+        {
+            board.Take(cell, 0);
+            taken[cell] = 1;
+        }
+    }
+    std::vector<uint32_t> starts(ROOM_CHECKS);
+    for (auto& start : starts)
+    {
+        start = random.Below(grid.GetSize());
+    }
+
+    std::vector<uint32_t> queue{};
+    std::vector<uint32_t> visited(grid.GetSize(), 0);
+    uint64_t byCellTotal = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < ROOM_CHECKS; i++)
+    {
+        byCellTotal += CountReachableByCell(taken, grid, starts[i], ROOM_LIMIT, queue, visited, i + 1);
+    }
+    auto byCellElapsed = std::chrono::steady_clock::now() - start;
+
+    uint64_t byWordTotal = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto cell : starts)
+    {
+        byWordTotal += board.CountReachable(cell, ROOM_LIMIT);
+    }
+    auto byWordElapsed = std::chrono::steady_clock::now() - start;
+
+    auto microseconds = [](std::chrono::steady_clock::duration elapsed){
+        return std::chrono::duration<double, std::micro>(elapsed).count() / ROOM_CHECKS;
+    };
+    output << "  cell by cell: " << microseconds(byCellElapsed) << " us per check" << std::endl;
+    output << "  bitboard:     " << microseconds(byWordElapsed) << " us per check, "
+        << (byCellTotal == byWordTotal ? "same rooms" : "ROOMS DIFFER") << std::endl;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ostream>
+
+namespace Snake
+{
+    /**
+     * @brief Headless measurements of the engine and its helpers.
+     */
+    class Benchmark
+    {
+    public:
+        /**
+         * @brief Run every measurement.
+         * 
+         * @return false if a measurement with a budget went over it.
+         */
+        static bool Run(std::ostream& output);
+
+    private:
+        /** Per tick cost of the periodic checkpoints of a running game, against its budget */
+        static bool Checkpoint(std::ostream& output);
+        /** Per tick cost of a distance field kept up to date against one rebuilt every tick */
+        static void Pathfinding(std::ostream& output);
+        /** Steps per second of VecEnv against as many GameEngines */
+        static void Batch(std::ostream& output);
+        /** Room counts of the safety checks, by bitboard words against cell by cell */
+        static void Room(std::ostream& output);
+    };
+}
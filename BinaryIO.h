@@ -0,0 +1,36 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Snake
+{
+    /**
+     * @brief Raw native endian values for the save files.
+     *      They are only read back on the same machine.
+     */
+    namespace BinaryIO
+    {
+        template <typename T>
+        void Write(std::ostream& output, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        template <typename T>
+        T Read(std::istream& input)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value{};
+            input.read(reinterpret_cast<char*>(&value), sizeof(value));
+            if (input.fail())
+            {
+                throw std::runtime_error("File is truncated");
+            }
+            return value;
+        }
+    }
+}
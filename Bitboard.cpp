@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include "Bitboard.h"
+
+using namespace Snake;
+
+namespace
+{
+    /** The lowest count bits set */
+    constexpr uint64_t LowBits(uint32_t count)
+    {
+        return count >= 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+    }
+}
+
+void Bitboard::Reset(uint32_t width, uint32_t height, bool wraps)
+{
+    _width = width;
+    _height = height;
+    _wraps = wraps;
+    size_t size = static_cast<size_t>(width) * height;
+    _taken.assign((size + 63) / 64, 0);
+    _walls.assign((size + 63) / 64, 0);
+    _directions.assign((size + 31) / 32, 0);
+}
+
+void Bitboard::SetWalls(std::span<const uint64_t> walls)
+{
+    for (size_t word = 0; word < _walls.size(); word++)
+    {
+        _walls[word] |= walls[word];
+        _taken[word] |= walls[word];
+    }
+}
+
+uint32_t Bitboard::GetWidth() const
+{
+    return _width;
+}
+
+uint32_t Bitboard::GetHeight() const
+{
+    return _height;
+}
+
+uint32_t Bitboard::CountFree(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const
+{
+    width = std::min(width, _width);
+    height = std::min(height, _height);
+    uint32_t taken = 0;
+    for (uint32_t row = 0; row < height; row++)
+    {
+        for (uint32_t column = 0; column < width; column += 64)
+        {
+            taken += static_cast<uint32_t>(std::popcount(
+                GetRow((x + column) % _width, (y + row) % _height, std::min(width - column, 64u))));
+        }
+    }
+    return width * height - taken;
+}
+
+bool Bitboard::IsAreaFree(uint32_t cell, uint32_t radius) const
+{
+    uint32_t side = 2*radius + 1;
+    uint32_t width = std::min(side, _width);
+    uint32_t height = std::min(side, _height);
+    uint32_t x = width == _width ? 0 : (cell % _width + _width - radius) % _width;
+    uint32_t y = height == _height ? 0 : (cell / _width + _height - radius) % _height;
+    return CountFree(x, y, width, height) == width * height;
+}
+
+uint32_t Bitboard::CountReachable(uint32_t from, uint32_t limit) const
+{
+    /**
+     * The window is copied out one word per row, then grown by a step in every
+     * direction at once until it stops changing: a row spreads sideways by shifting
+     * its word, and up and down by or-ing the words of the rows next to it.
+     * Rows are stored from 1 with an empty row on each side, so the loop has no
+     * branches, and only rows the reach has come near are grown.
+     * A window as wide or as high as a board that wraps wraps around like the board.
+     * On a board that does not, the window is kept inside it.
+     */
+    uint32_t width = std::min(WINDOW, _width);
+    uint32_t height = std::min(WINDOW, _height);
+    bool wrapY = _wraps && height == _height;
+    uint64_t wrapX = _wraps && width == _width ? 1 : 0;
+    uint32_t fromX = from % _width;
+    uint32_t fromY = from / _width;
+    auto place = [this](uint32_t from, uint32_t window, uint32_t size){
+        if (window == size)
+        {
+            return 0u;
+        }
+        if (_wraps)
+        {
+            return (from + size - window/2) % size;
+        }
+        return std::min(from - std::min(from, window/2), size - window);
+    };
+    uint32_t x = place(fromX, width, _width);
+    uint32_t y = place(fromY, height, _height);
+    uint64_t mask = LowBits(width);
+    std::array<uint64_t, WINDOW + 2> free{};
+    std::array<uint64_t, WINDOW + 2> reach{};
+    std::array<uint64_t, WINDOW + 2> next{};
+    for (uint32_t row = 0; row < height; row++)
+    {
+        free[row + 1] = ~GetRow(x, (y + row) % _height, width) & mask;
+    }
+    uint32_t start = (fromY + _height - y) % _height + 1;
+    reach[start] = uint64_t{1} << ((fromX + _width - x) % _width);
+    uint32_t first = start;
+    uint32_t last = start;
+    while (true)
+    {
+        if (wrapY)
+        {
+            first = 1;
+            last = height;
+            reach[0] = reach[height];
+            reach[height + 1] = reach[1];
+        }
+        else
+        {
+            first = std::max(first - 1, 1u);
+            last = std::min(last + 1, height);
+        }
+        uint64_t changed = 0;
+        uint32_t count = 0;
+        for (uint32_t row = first; row <= last; row++)
+        {
+            auto bits = reach[row];
+            auto grown = bits | bits << 1 | bits >> 1 | reach[row - 1] | reach[row + 1] |
+                (bits >> (width - 1) & wrapX) | (bits & wrapX) << (width - 1);
+            next[row] = grown & free[row];
+            changed |= next[row] ^ bits;
+            count += static_cast<uint32_t>(std::popcount(next[row]));
+        }
+        if (changed == 0 || count >= limit)
+        {
+            return std::min(count, limit);
+        }
+        std::copy(next.begin() + first, next.begin() + last + 1, reach.begin() + first);
+    }
+}
+
+uint64_t Bitboard::GetRow(uint32_t x, uint32_t y, uint32_t count) const
+{
+    uint32_t start = y*_width;
+    uint32_t first = std::min(count, _width - x);
+    uint64_t bits = GetBits(start + x, first);
+    if (count > first)
+    {
+        bits |= GetBits(start, count - first) << first;
+    }
+    return bits;
+}
+
+uint64_t Bitboard::GetBits(uint32_t start, uint32_t count) const
+{
+    uint32_t word = start / 64;
+    uint32_t offset = start % 64;
+    uint64_t bits = _taken[word] >> offset;
+    if (offset != 0 && offset + count > 64)
+    {
+        bits |= _taken[word + 1] << (64 - offset);
+    }
+    return bits & LowBits(count);
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stdint.h>
+#include <span>
+#include <vector>
+
+namespace Snake
+{
+    /**
+     * @brief The cells of a board, packed in 64 bit words.
+     *      One bit per cell tells whether it is taken, and two more give the
+     *      direction a taken cell was entered with. Walls are taken cells with
+     *      a bit of their own. Cells are indexed row after row.
+     *      Region queries work on a word of cells at a time.
+     */
+    class Bitboard
+    {
+    public:
+        /** CountReachable looks at most this many cells across and down from the start */
+        static constexpr uint32_t WINDOW = 64;
+
+        Bitboard() = default;
+        ~Bitboard() = default;
+        Bitboard(const Bitboard& other) = default;
+        Bitboard& operator=(const Bitboard& other) = default;
+        Bitboard(Bitboard&& other) noexcept = default;
+        Bitboard& operator=(Bitboard&& other) noexcept = default;
+
+        /**
+         * @brief Size the board and free every cell.
+         *
+         * @param width At least 1.
+         * @param height At least 1.
+         * @param wraps Whether the edges lead around to the other side, for CountReachable.
+         */
+        void Reset(uint32_t width, uint32_t height, bool wraps);
+
+        uint32_t GetWidth() const;
+        uint32_t GetHeight() const;
+
+        /** Single cells are in the header, the engine and the searches call these on every step */
+        bool IsFree(uint32_t cell) const
+        {
+            return (_taken[cell / 64] >> (cell % 64) & 1) == 0;
+        }
+
+        /**
+         * @brief Mark a cell taken.
+         *
+         * @param cell
+         * @param direction Below 4, kept for GetDirection.
+         */
+        void Take(uint32_t cell, uint8_t direction)
+        {
+            _taken[cell / 64] |= uint64_t{1} << (cell % 64);
+            auto& word = _directions[cell / 32];
+            auto shift = cell % 32 * 2;
+            word = (word & ~(uint64_t{3} << shift)) | static_cast<uint64_t>(direction & 3) << shift;
+        }
+
+        void Free(uint32_t cell)
+        {
+            _taken[cell / 64] &= ~(uint64_t{1} << (cell % 64));
+        }
+
+        /** Take a cell for good, it is never freed */
+        void SetWall(uint32_t cell)
+        {
+            _taken[cell / 64] |= uint64_t{1} << (cell % 64);
+            _walls[cell / 64] |= uint64_t{1} << (cell % 64);
+        }
+
+        /**
+         * @brief Add the walls of a whole board a word at a time.
+         *
+         * @param walls A bit per cell, laid out like the board, as many words as it has.
+         */
+        void SetWalls(std::span<const uint64_t> walls);
+
+        bool IsWall(uint32_t cell) const
+        {
+            return (_walls[cell / 64] >> (cell % 64) & 1) != 0;
+        }
+
+        /** The direction a taken cell was given */
+        uint8_t GetDirection(uint32_t cell) const
+        {
+            return static_cast<uint8_t>(_directions[cell / 32] >> (cell % 32 * 2) & 3);
+        }
+
+        /**
+         * @brief Free cells in a rectangle, which may wrap around the edges.
+         *      Sizes larger than the board are cut down to it.
+         */
+        uint32_t CountFree(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+        /** Whether every cell within radius steps across and down of a cell is free, the cell too */
+        bool IsAreaFree(uint32_t cell, uint32_t radius) const;
+        /**
+         * @brief Free cells that can be reached from a cell, the cell itself need not be free.
+         *      The search stays within a WINDOW square around the start, so a way
+         *      out that only comes back through cells further away is not found.
+         *      It only goes past the edges of a board that wraps.
+         *
+         * @param from
+         * @param limit Counting stops at this many cells.
+         * @return At most limit.
+         */
+        uint32_t CountReachable(uint32_t from, uint32_t limit) const;
+
+    private:
+        uint32_t _width{0};
+        uint32_t _height{0};
+        bool _wraps{true};
+        /** A bit per cell */
+        std::vector<uint64_t> _taken{};
+        /** A bit per cell */
+        std::vector<uint64_t> _walls{};
+        /** Two bits per cell */
+        std::vector<uint64_t> _directions{};
+
+        /** Taken bits of up to 64 cells in a row from x, wrapping around the end of the row */
+        uint64_t GetRow(uint32_t x, uint32_t y, uint32_t count) const;
+        /** Taken bits of up to 64 cells from an index, which do not go past the end of the board */
+        uint64_t GetBits(uint32_t start, uint32_t count) const;
+    };
+}
@@ -0,0 +1,164 @@
+#include <fstream>
+#include <algorithm>
+#include "Checkpointer.h"
+
+using namespace Snake;
+
+Checkpointer::Checkpointer(const std::filesystem::path& path)
+    : _path(path),
+      _temporaryPath(path)
+{
+    _temporaryPath += ".tmp";
+    _thread = std::thread(&Checkpointer::WriterThread, this);
+}
+
+Checkpointer::~Checkpointer()
+{
+    {
+        std::lock_guard lock{_mutex};
+        _stopping = true;
+    }
+    _changed.notify_all();
+    _thread.join();
+}
+
+void Checkpointer::SetHeader(const Writer& header)
+{
+    std::unique_lock lock{_mutex};
+    _changed.wait(lock, [this](){
+        return !_pending;
+    });
+    _header = header;
+    _log.clear();
+    _written = false;
+}
+
+bool Checkpointer::Capture(const Writer& writer, const Writer& log)
+{
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard lock{_mutex};
+        if (_pending)
+        {
+            _statistics.skipped++;
+            return false;
+        }
+    }
+    /** The writer thread never touches the front buffer */
+    _front.data.clear();
+    std::ostream stream{&_front};
+    writer(stream);
+    _frontLog.data.clear();
+    if (log)
+    {
+        std::ostream logStream{&_frontLog};
+        log(logStream);
+    }
+    {
+        std::lock_guard lock{_mutex};
+        /** A paused game saved again, the file already holds this snapshot */
+        bool unchanged = _written && _frontLog.data.empty() && _front.data == _back.data;
+        if (!unchanged)
+        {
+            std::swap(_front.data, _back.data);
+            std::swap(_frontLog.data, _backLog.data);
+            _pending = true;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    _statistics.captures++;
+    _statistics.captureTime += elapsed;
+    _statistics.maxCaptureTime = std::max<std::chrono::nanoseconds>(_statistics.maxCaptureTime, elapsed);
+    _changed.notify_all();
+    return true;
+}
+
+void Checkpointer::Save(const Writer& writer, const Writer& log)
+{
+    Flush();
+    Capture(writer, log);
+    Flush();
+}
+
+void Checkpointer::Remove()
+{
+    Flush();
+    {
+        std::lock_guard lock{_mutex};
+        _written = false;
+    }
+    std::error_code error{};
+    std::filesystem::remove(_path, error);
+}
+
+const Checkpointer::Statistics& Checkpointer::GetStatistics() const
+{
+    return _statistics;
+}
+
+void Checkpointer::Flush()
+{
+    std::unique_lock lock{_mutex};
+    _changed.wait(lock, [this](){
+        return !_pending;
+    });
+}
+
+void Checkpointer::WriterThread()
+{
+    std::unique_lock lock{_mutex};
+    while (true)
+    {
+        _changed.wait(lock, [this](){
+            return _stopping || _pending;
+        });
+        if (!_pending)
+        {
+            /** Stopping */
+            return;
+        }
+        /** The back buffers, the header and the log are ours until _pending is cleared */
+        lock.unlock();
+        bool written = false;
+        try
+        {
+            _log.insert(_log.end(), _backLog.data.begin(), _backLog.data.end());
+            std::ofstream file(_temporaryPath, std::ios::binary | std::ios::trunc);
+            if (_header)
+            {
+                _header(file);
+            }
+            file.write(_back.data.data(), static_cast<std::streamsize>(_back.data.size()));
+            file.write(_log.data(), static_cast<std::streamsize>(_log.size()));
+            file.close();
+            if (!file.fail())
+            {
+                std::filesystem::rename(_temporaryPath, _path);
+                written = true;
+            }
+        }
+        catch (const std::exception&)
+        {
+            /** Try again with the next snapshot */
+        }
+        lock.lock();
+        _written = written;
+        _pending = false;
+        _changed.notify_all();
+    }
+}
+
+Checkpointer::Buffer::int_type Checkpointer::Buffer::overflow(int_type c)
+{
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        data.push_back(traits_type::to_char_type(c));
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize Checkpointer::Buffer::xsputn(const char* s, std::streamsize count)
+{
+    data.insert(data.end(), s, s + count);
+    return count;
+}
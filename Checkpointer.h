@@ -0,0 +1,111 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <filesystem>
+#include <streambuf>
+#include <ostream>
+#include <vector>
+#include <chrono>
+
+namespace Snake
+{
+    /**
+     * @brief Writes snapshots to a file on a background thread.
+     *      The snapshot is serialized into one of two reusable buffers 
+     *      on the calling thread, the other one is being written meanwhile.
+     *      What does not change between snapshots goes in a header, and what only grows
+     *      in a log that each snapshot appends to. The background thread keeps both
+     *      and writes the file as the header, the snapshot and then the log.
+     *      The file is replaced with a rename, so it is always complete.
+     */
+    class Checkpointer
+    {
+    public:
+        typedef std::function<void(std::ostream&)> Writer;
+        struct Statistics
+        {
+            size_t captures{0};
+            /** Captures dropped because the last one was still being written */
+            size_t skipped{0};
+            std::chrono::nanoseconds captureTime{0};
+            std::chrono::nanoseconds maxCaptureTime{0};
+        };
+
+        Checkpointer(const std::filesystem::path& path);
+        ~Checkpointer();
+
+        Checkpointer(const Checkpointer& other) = delete;
+        Checkpointer& operator=(const Checkpointer& other) = delete;
+        Checkpointer(Checkpointer&& other) noexcept = delete;
+        Checkpointer& operator=(Checkpointer&& other) noexcept = delete;
+
+        /**
+         * @brief Set what is written ahead of every snapshot and empty the log,
+         *      after the pending write.
+         * 
+         * @param header Called on the background thread, so it must only read data
+         *      that is never changed, such as a shared level.
+         */
+        void SetHeader(const Writer& header);
+        /**
+         * @brief Take a snapshot without blocking.
+         * 
+         * @param writer Serializes the snapshot.
+         * @param log Appends what was added to the log since the last snapshot taken,
+         *      it is only called when this one is taken.
+         * @return false if skipped because the last snapshot is still being written.
+         */
+        bool Capture(const Writer& writer, const Writer& log = nullptr);
+        /**
+         * @brief Take a snapshot and wait until it is on the disk.
+         *      Nothing is written if the file already holds the same snapshot and log,
+         *      so saving a game that has not moved since its last checkpoint is cheap.
+         * 
+         * @param writer 
+         * @param log 
+         */
+        void Save(const Writer& writer, const Writer& log = nullptr);
+        /**
+         * @brief Wait for the pending write and delete the file.
+         */
+        void Remove();
+        const Statistics& GetStatistics() const;
+
+    private:
+        /** Appends to a vector that keeps its capacity between snapshots */
+        class Buffer : public std::streambuf
+        {
+        public:
+            std::vector<char> data{};
+        protected:
+            int_type overflow(int_type c) override;
+            std::streamsize xsputn(const char* s, std::streamsize count) override;
+        };
+
+        std::filesystem::path _path;
+        std::filesystem::path _temporaryPath;
+        Buffer _front{};
+        Buffer _frontLog{};
+        Statistics _statistics{};
+        /** The whole log, only the writer thread touches it while a snapshot is pending */
+        std::vector<char> _log{};
+
+        /** Shared with the writer thread */
+        std::mutex _mutex{};
+        std::condition_variable _changed{};
+        Buffer _back{};
+        Buffer _backLog{};
+        Writer _header{};
+        bool _pending{false};
+        /** The file holds the header, the back buffer and the log */
+        bool _written{false};
+        bool _stopping{false};
+        std::thread _thread{};
+
+        void Flush();
+        void WriterThread();
+    };
+}
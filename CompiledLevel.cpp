@@ -0,0 +1,341 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <stdexcept>
+#include "CompiledLevel.h"
+#include "GameEngine.h"
+
+using namespace Snake;
+
+namespace
+{
+    constexpr uint32_t MAGIC = 0x564C4E53; /** "SNLV" */
+    constexpr uint32_t VERSION = 1;
+    /** Names come from file names */
+    constexpr uint32_t MAX_NAME = 255;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        Level::Edges edges;
+        uint8_t reserved[3];
+        uint32_t nameSize;
+        uint32_t spawnCount;
+        uint32_t reserved2;
+    };
+    static_assert(sizeof(Header) == 32);
+
+    struct SpawnRecord
+    {
+        uint32_t head;
+        uint8_t direction;
+        uint8_t reserved[3];
+    };
+    static_assert(sizeof(SpawnRecord) == 8);
+
+    /** Where the parts of an image start, every part is 8 byte aligned */
+    struct Layout
+    {
+        size_t spawns;
+        size_t walls;
+        size_t freeColumns;
+        size_t size;
+        size_t words;
+    };
+
+    Layout GetLayout(const Header& header)
+    {
+        Layout layout{};
+        size_t cellCount = static_cast<size_t>(header.width) * header.height;
+        layout.words = (cellCount + 63) / 64;
+        layout.spawns = sizeof(Header) + (header.nameSize + 7) / 8 * 8;
+        layout.walls = layout.spawns + sizeof(SpawnRecord) * header.spawnCount;
+        layout.freeColumns = layout.walls + sizeof(uint64_t) * layout.words;
+        layout.size = layout.freeColumns + sizeof(uint64_t) * layout.words;
+        return layout;
+    }
+
+    void SetBit(uint64_t* words, size_t bit)
+    {
+        words[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+}
+
+CompiledLevel::~CompiledLevel()
+{
+    if (_mapping != nullptr)
+    {
+        munmap(_mapping, _size);
+    }
+}
+
+std::shared_ptr<const CompiledLevel> CompiledLevel::Compile(const Level& level)
+{
+    if (level.width < GameEngine::MIN_WIDTH || level.height < 1 ||
+        level.width > GameEngine::MAX_SIZE || level.height > GameEngine::MAX_SIZE)
+    {
+        throw std::invalid_argument("Invalid board size");
+    }
+    if (static_cast<uint8_t>(level.edges) > static_cast<uint8_t>(Level::Edges::Solid))
+    {
+        throw std::invalid_argument("Invalid level edges");
+    }
+    auto cellCount = static_cast<uint32_t>(level.width * level.height);
+    for (size_t i = 0; i < level.walls.size(); i++)
+    {
+        if (level.walls[i] >= cellCount || (i > 0 && level.walls[i] <= level.walls[i - 1]))
+        {
+            throw std::invalid_argument("Invalid level walls");
+        }
+    }
+    if (level.spawns.empty() || level.spawns.size() > cellCount)
+    {
+        throw std::invalid_argument("Invalid level spawns");
+    }
+    if (level.name.size() > MAX_NAME)
+    {
+        throw std::invalid_argument("Invalid level name");
+    }
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.width = static_cast<uint32_t>(level.width);
+    header.height = static_cast<uint32_t>(level.height);
+    header.edges = level.edges;
+    header.nameSize = static_cast<uint32_t>(level.name.size());
+    header.spawnCount = static_cast<uint32_t>(level.spawns.size());
+    auto layout = GetLayout(header);
+    std::shared_ptr<CompiledLevel> compiled{new CompiledLevel{}};
+    auto& image = compiled->_image;
+    image.assign(layout.size / sizeof(uint64_t), 0);
+    auto* data = reinterpret_cast<std::byte*>(image.data());
+    std::memcpy(data, &header, sizeof(header));
+    std::memcpy(data + sizeof(header), level.name.data(), level.name.size());
+    for (size_t i = 0; i < level.spawns.size(); i++)
+    {
+        SpawnRecord record{level.spawns[i].head, level.spawns[i].direction, {}};
+        std::memcpy(data + layout.spawns + sizeof(record) * i, &record, sizeof(record));
+    }
+    auto* walls = image.data() + layout.walls / sizeof(uint64_t);
+    for (auto wall : level.walls)
+    {
+        SetBit(walls, wall);
+    }
+    auto* freeColumns = image.data() + layout.freeColumns / sizeof(uint64_t);
+    auto width = header.width;
+    auto height = header.height;
+    for (uint32_t x = 0; x < width; x++)
+    {
+        for (uint32_t y = 0; y < height; y++)
+        {
+            auto cell = x + y*width;
+            if ((walls[cell / 64] >> (cell % 64) & 1) == 0)
+            {
+                SetBit(freeColumns, y + x*height);
+            }
+        }
+    }
+    compiled->_size = layout.size;
+    compiled->_data = data;
+    compiled->Open();
+    return compiled;
+}
+
+std::shared_ptr<const CompiledLevel> CompiledLevel::Map(const std::filesystem::path& path)
+{
+    int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+    {
+        throw std::runtime_error("Failed to open compiled level");
+    }
+    struct stat status{};
+    if (fstat(file, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(Header)))
+    {
+        close(file);
+        throw std::runtime_error("Invalid compiled level");
+    }
+    auto size = static_cast<size_t>(status.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Failed to map compiled level");
+    }
+    /** Owned from here, so a failed check unmaps it */
+    std::shared_ptr<CompiledLevel> compiled{new CompiledLevel{}};
+    compiled->_mapping = mapping;
+    compiled->_size = size;
+    compiled->_data = static_cast<const std::byte*>(mapping);
+    compiled->Open();
+    return compiled;
+}
+
+void CompiledLevel::Open()
+{
+    auto fail = [](){
+        throw std::runtime_error("Invalid compiled level");
+    };
+    Header header{};
+    if (_size < sizeof(header))
+    {
+        fail();
+    }
+    std::memcpy(&header, _data, sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION ||
+        header.width < static_cast<uint32_t>(GameEngine::MIN_WIDTH) || header.height < 1 ||
+        header.width > static_cast<uint32_t>(GameEngine::MAX_SIZE) ||
+        header.height > static_cast<uint32_t>(GameEngine::MAX_SIZE) ||
+        static_cast<uint8_t>(header.edges) > static_cast<uint8_t>(Level::Edges::Solid) ||
+        header.nameSize > MAX_NAME)
+    {
+        fail();
+    }
+    auto cellCount = header.width * header.height;
+    if (header.spawnCount == 0 || header.spawnCount > cellCount)
+    {
+        fail();
+    }
+    auto layout = GetLayout(header);
+    if (layout.size != _size)
+    {
+        fail();
+    }
+    _name = {reinterpret_cast<const char*>(_data + sizeof(header)), header.nameSize};
+    _width = static_cast<int>(header.width);
+    _height = static_cast<int>(header.height);
+    _edges = header.edges;
+    _spawns = _data + layout.spawns;
+    _spawnCount = header.spawnCount;
+    _walls = {reinterpret_cast<const uint64_t*>(_data + layout.walls), layout.words};
+    _freeColumns = {reinterpret_cast<const uint64_t*>(_data + layout.freeColumns), layout.words};
+    /** Nothing past the last cell, and every cell either a wall or free */
+    uint64_t padding = cellCount % 64 == 0 ? 0 : ~uint64_t{0} << (cellCount % 64);
+    if ((_walls.back() & padding) != 0 || (_freeColumns.back() & padding) != 0)
+    {
+        fail();
+    }
+    size_t freeCount = 0;
+    for (size_t word = 0; word < layout.words; word++)
+    {
+        _wallCount += static_cast<size_t>(std::popcount(_walls[word]));
+        freeCount += static_cast<size_t>(std::popcount(_freeColumns[word]));
+    }
+    if (_wallCount + freeCount != cellCount)
+    {
+        fail();
+    }
+    /** The snake starts behind the head, and its first step must not kill it */
+    auto wraps = _edges == Level::Edges::Wrap;
+    for (size_t i = 0; i < _spawnCount; i++)
+    {
+        auto spawn = GetSpawn(i);
+        if (spawn.head >= cellCount || spawn.direction > static_cast<uint8_t>(GameEngine::Direction::Right))
+        {
+            throw std::invalid_argument("Invalid level spawn");
+        }
+        auto direction = static_cast<GameEngine::Direction>(spawn.direction);
+        auto step = [&](int x, int y, int distance){
+            switch (direction)
+            {
+            case GameEngine::Direction::Up:
+                y -= distance;
+                break;
+            case GameEngine::Direction::Down:
+                y += distance;
+                break;
+            case GameEngine::Direction::Left:
+                x -= distance;
+                break;
+            case GameEngine::Direction::Right:
+                x += distance;
+                break;
+            }
+            if (!wraps && (x < 0 || y < 0 || x >= _width || y >= _height))
+            {
+                return false;
+            }
+            x = (x + _width) % _width;
+            y = (y + _height) % _height;
+            return !IsWall(static_cast<uint32_t>(x + y*_width));
+        };
+        int x = static_cast<int>(spawn.head % header.width);
+        int y = static_cast<int>(spawn.head / header.width);
+        for (int distance = 1 - Level::SPAWN_LENGTH; distance <= 1; distance++)
+        {
+            if (!step(x, y, distance))
+            {
+                throw std::invalid_argument("Level blocks a spawn");
+            }
+        }
+    }
+}
+
+std::string_view CompiledLevel::GetName() const
+{
+    return _name;
+}
+
+int CompiledLevel::GetWidth() const
+{
+    return _width;
+}
+
+int CompiledLevel::GetHeight() const
+{
+    return _height;
+}
+
+Level::Edges CompiledLevel::GetEdges() const
+{
+    return _edges;
+}
+
+size_t CompiledLevel::GetWallCount() const
+{
+    return _wallCount;
+}
+
+size_t CompiledLevel::GetSpawnCount() const
+{
+    return _spawnCount;
+}
+
+Level::Spawn CompiledLevel::GetSpawn(size_t index) const
+{
+    SpawnRecord record{};
+    std::memcpy(&record, _spawns + sizeof(record) * index, sizeof(record));
+    return {record.head, record.direction};
+}
+
+std::span<const uint64_t> CompiledLevel::GetWalls() const
+{
+    return _walls;
+}
+
+std::span<const uint64_t> CompiledLevel::GetFreeColumns() const
+{
+    return _freeColumns;
+}
+
+Level CompiledLevel::ToLevel() const
+{
+    Level level{std::string{_name}, _width, _height, _edges, {}, {}};
+    ForEachWall([&](uint32_t wall){
+        level.walls.push_back(wall);
+    });
+    for (size_t i = 0; i < _spawnCount; i++)
+    {
+        level.spawns.push_back(GetSpawn(i));
+    }
+    return level;
+}
+
+void CompiledLevel::Write(std::ostream& output) const
+{
+    output.write(reinterpret_cast<const char*>(_data), static_cast<std::streamsize>(_size));
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include <bit>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+#include <ostream>
+#include "Level.h"
+
+namespace Snake
+{
+    /**
+     * @brief A level in the form the engine plays, one image that is never parsed.
+     *      The image is a header, the name, the spawns and two planes of 64 bit words:
+     *      the walls row after row, as in Bitboard, and the free cells column after column,
+     *      the order the food pool is filled in. It is built from a Level,
+     *      or mapped straight from a file written by Write, and shared by every game on it.
+     *      Words are in the byte order of the machine that compiled the level.
+     */
+    class CompiledLevel
+    {
+    public:
+        /** Files compiled from NAME.level are named NAME.snl */
+        static constexpr std::string_view EXTENSION = ".snl";
+
+        ~CompiledLevel();
+
+        CompiledLevel(const CompiledLevel& other) = delete;
+        CompiledLevel& operator=(const CompiledLevel& other) = delete;
+        CompiledLevel(CompiledLevel&& other) noexcept = delete;
+        CompiledLevel& operator=(CompiledLevel&& other) noexcept = delete;
+
+        /**
+         * @brief Build the image in memory, of a size GameEngine plays.
+         *      The walls must be in increasing order, and the cells of every spawn,
+         *      with the one in front of its head, free and inside the board.
+         */
+        static std::shared_ptr<const CompiledLevel> Compile(const Level& level);
+        /**
+         * @brief Map a compiled file read only, it is used in place.
+         *      The header, the spawns and the sizes are checked,
+         *      the free plane is taken to be the complement of the walls.
+         */
+        static std::shared_ptr<const CompiledLevel> Map(const std::filesystem::path& path);
+
+        std::string_view GetName() const;
+        int GetWidth() const;
+        int GetHeight() const;
+        Level::Edges GetEdges() const;
+        size_t GetWallCount() const;
+        size_t GetSpawnCount() const;
+        Level::Spawn GetSpawn(size_t index) const;
+        /** Row after row, a bit per cell */
+        std::span<const uint64_t> GetWalls() const;
+        /** Column after column, bit y + x*height is cell x + y*width */
+        std::span<const uint64_t> GetFreeColumns() const;
+
+        bool IsWall(uint32_t cell) const
+        {
+            return (_walls[cell / 64] >> (cell % 64) & 1) != 0;
+        }
+
+        /** Call f with the index of every wall, in increasing order, a word at a time */
+        template <typename F>
+        void ForEachWall(F f) const
+        {
+            for (size_t word = 0; word < _walls.size(); word++)
+            {
+                for (auto bits = _walls[word]; bits != 0; bits &= bits - 1)
+                {
+                    f(static_cast<uint32_t>(word*64 + static_cast<size_t>(std::countr_zero(bits))));
+                }
+            }
+        }
+
+        /** Back to the editable form, replays store that */
+        Level ToLevel() const;
+        /** The image, for Map */
+        void Write(std::ostream& output) const;
+
+    private:
+        /** Built in memory, kept in words so the planes are aligned */
+        std::vector<uint64_t> _image{};
+        /** Mapped from a file */
+        void* _mapping{nullptr};
+        size_t _size{0};
+        const std::byte* _data{nullptr};
+        std::string_view _name{};
+        int _width{0};
+        int _height{0};
+        Level::Edges _edges{Level::Edges::Wrap};
+        const std::byte* _spawns{nullptr};
+        size_t _spawnCount{0};
+        size_t _wallCount{0};
+        std::span<const uint64_t> _walls{};
+        std::span<const uint64_t> _freeColumns{};
+
+        CompiledLevel() = default;
+        /** Check the image at _data and find its parts, throws if it is not a level */
+        void Open();
+    };
+}
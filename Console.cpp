@@ -1,12 +1,17 @@
 #include "Console.h"
 #include <termios.h>
+#include <sys/ioctl.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <cstring>
+#include <cstdlib>
 #include <stdexcept>
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include "Constants.h"
 
 using namespace Snake;
 
@@ -26,8 +31,8 @@ Console::Console(Tev& tev)
     {
         throw std::runtime_error("tcsetattr failed");
     }
-    /** Hide the cursor */
-    std::cout << "\x1b[?25l";
+    /** Switch to the alternate screen, keeping the scrollback, and hide the cursor */
+    std::cout << "\x1b[?1049h\x1b[?25l";
     std::flush(std::cout);
     /** Set stdin to non-blocking */
     int flags = fcntl(STDIN_FILENO, F_GETFL, 0);
@@ -43,6 +48,8 @@ Console::Console(Tev& tev)
     }
     /** Set stdin read handler */
     _readHandler = _tev.SetReadHandler(STDIN_FILENO, std::bind(&Console::TerminalKeyHandler, this));
+    UpdateSize();
+    DetectCapabilities();
 }
 
 Console::~Console()
@@ -65,12 +72,13 @@ void Console::Close()
     _closed = true;
     /** Remove stdin read handler */
     _readHandler.Clear();
+    _resizeTimer.Clear();
     /** Reset cursor position and color */
     PutString(0, 0, "\x1b[0m");
     /** Clear screen */
     Clear();
-    /** Show the cursor */
-    std::cout << "\x1b[?25h";
+    /** Show the cursor and go back to the primary screen */
+    std::cout << "\x1b[?25h\x1b[?1049l";
     std::flush(std::cout);
     /** Change back to "cooked" mode */
     struct termios attr;
@@ -166,6 +174,18 @@ void Console::TerminalKeyHandler()
             keySequence = std::string{_inputBuffer[0]};
             _inputBuffer.pop_front();
         }
+        if (keySequence.starts_with(SYNCHRONIZED_UPDATE_REPORT) && keySequence.ends_with("$y"))
+        {
+            /** 1 is set and 2 is reset, 0 and 4 mean the mode is unknown or cannot change */
+            auto state = keySequence.substr(SYNCHRONIZED_UPDATE_REPORT.size());
+            _canSynchronize = state == "1$y" || state == "2$y";
+            continue;
+        }
+        if (keySequence == REPEAT_REPORT || keySequence == NO_REPEAT_REPORT)
+        {
+            _canRepeat = keySequence == REPEAT_REPORT;
+            continue;
+        }
         auto handler = _keyHandlers.find(keySequence);
         if (handler != _keyHandlers.end())
         {
@@ -186,30 +206,48 @@ void Console::SetKeyHandler(char key, Console::KeyHandler handler)
 
 void Console::SetKeyHandler(EscapedKeys key, Console::KeyHandler handler)
 {
-    std::string keySequence{};
+    /** Some keys are reported differently depending on the terminal */
+    std::vector<std::string> keySequences{};
     switch (key)
     {
     case EscapedKeys::Up:
-        keySequence = "\x1b[A";
+        keySequences = {"\x1b[A"};
         break;
     case EscapedKeys::Down:
-        keySequence = "\x1b[B";
+        keySequences = {"\x1b[B"};
         break;
     case EscapedKeys::Right:
-        keySequence = "\x1b[C";
+        keySequences = {"\x1b[C"};
         break;
     case EscapedKeys::Left:
-        keySequence = "\x1b[D";
+        keySequences = {"\x1b[D"};
+        break;
+    case EscapedKeys::PageUp:
+        keySequences = {"\x1b[5~"};
+        break;
+    case EscapedKeys::PageDown:
+        keySequences = {"\x1b[6~"};
+        break;
+    case EscapedKeys::Home:
+        keySequences = {"\x1b[H", "\x1b[1~", "\x1b[7~"};
+        break;
+    case EscapedKeys::End:
+        keySequences = {"\x1b[F", "\x1b[4~", "\x1b[8~"};
         break;
     default:
         throw std::runtime_error("Unknown key");
     }
-    if (handler == nullptr)
+    for (const auto& keySequence : keySequences)
     {
-        _keyHandlers.erase(keySequence);
-        return;
+        if (handler == nullptr)
+        {
+            _keyHandlers.erase(keySequence);
+        }
+        else
+        {
+            _keyHandlers[keySequence] = handler;
+        }
     }
-    _keyHandlers[keySequence] = handler;
 }
 
 void Console::TerminalStringHandler()
@@ -350,11 +388,115 @@ void Console::GetString(size_t x, size_t y, size_t maxLength, Console::StringHan
     std::flush(std::cout);
 }
 
+size_t Console::GetWidth() const
+{
+    return _width;
+}
+
+size_t Console::GetHeight() const
+{
+    return _height;
+}
+
+void Console::NotifyResize()
+{
+    if (_closed)
+    {
+        return;
+    }
+    /** Start over on every call, only the last one of a burst fires */
+    _resizeTimer.Clear();
+    _resizeTimer = _tev.SetTimeout([this](){
+        if (!UpdateSize() || !_resizeHandler)
+        {
+            return;
+        }
+        BeginFrame();
+        Clear();
+        _resizeHandler();
+        if (_stringHandler)
+        {
+            /** Put back what is typed so far, leaving the cursor after it */
+            PutString(_inputString.x, _inputString.y, _inputString.input);
+        }
+        EndFrame();
+    }, RESIZE_DELAY_MS);
+}
+
+void Console::SetResizeHandler(ResizeHandler handler)
+{
+    _resizeHandler = handler;
+}
+
+bool Console::UpdateSize()
+{
+    struct winsize size{};
+    size_t width = Constants::DISPLAY_WIDTH;
+    size_t height = Constants::DISPLAY_HEIGHT;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0)
+    {
+        /** A smaller terminal gets the minimum layout and clips it */
+        width = std::max(width, static_cast<size_t>(size.ws_col));
+        height = std::max(height, static_cast<size_t>(size.ws_row));
+    }
+    if (width == _width && height == _height)
+    {
+        return false;
+    }
+    _width = width;
+    _height = height;
+    return true;
+}
+
 void Console::Clear()
 {
-    std::cout << "\x1b[39m"
-        << "\x1b[49m" 
-        << "\x1b[2J";
+    _foreground = ForegroundColor::Default;
+    _background = BackgroundColor::Default;
+    Write("\x1b[39m"
+        "\x1b[49m" 
+        "\x1b[2J");
+}
+
+void Console::BeginFrame()
+{
+    _frameDepth++;
+}
+
+void Console::EndFrame()
+{
+    if (_frameDepth == 0)
+    {
+        throw std::logic_error("EndFrame without BeginFrame");
+    }
+    if (--_frameDepth > 0)
+    {
+        return;
+    }
+    if (_frame.empty())
+    {
+        return;
+    }
+    if (_canSynchronize)
+    {
+        /** The terminal holds the screen until the end marker, so a frame never tears */
+        std::cout << "\x1b[?2026h" << _frame << "\x1b[?2026l";
+    }
+    else
+    {
+        std::cout << _frame;
+    }
+    std::flush(std::cout);
+    _frame.clear();
+}
+
+void Console::Write(const std::string_view& str)
+{
+    if (_frameDepth > 0)
+    {
+        _frame.append(str);
+        return;
+    }
+    std::cout << str;
     std::flush(std::cout);
 }
 
@@ -364,9 +506,175 @@ void Console::PutString(
     ForegroundColor foreGround,
     BackgroundColor backGround)
 {
-    std::cout << "\x1b[" << (y + 1) << ";" << (x + 1) << "H"
-        << "\x1b[" << static_cast<int>(foreGround) << "m"
-        << "\x1b[" << static_cast<int>(backGround) << "m"
-        << str;
-    std::flush(std::cout);
+    std::string output = "\x1b[" + std::to_string(y + 1) + ";" + std::to_string(x + 1) + "H";
+    if (_foreground != foreGround)
+    {
+        output += "\x1b[" + std::to_string(static_cast<int>(foreGround)) + "m";
+        _foreground = foreGround;
+    }
+    if (_background != backGround)
+    {
+        output += "\x1b[" + std::to_string(static_cast<int>(backGround)) + "m";
+        _background = backGround;
+    }
+    /** Erased cells get the current background only where the terminal has BCE */
+    Encode(output, str, x, backGround == BackgroundColor::Default);
+    Write(output);
+}
+
+namespace
+{
+    size_t GetUtf8Length(char lead)
+    {
+        auto byte = static_cast<uint8_t>(lead);
+        if (byte >= 0xF0)
+        {
+            return 4;
+        }
+        if (byte >= 0xE0)
+        {
+            return 3;
+        }
+        if (byte >= 0xC0)
+        {
+            return 2;
+        }
+        return 1;
+    }
+
+    /**
+     * @brief Whether a character is known to take one column.
+     *      Printable ASCII, box drawing, block elements and braille.
+     *      Emoji and the like are wide or vary between terminals.
+     */
+    bool IsNarrow(const std::string_view& glyph)
+    {
+        if (glyph.size() == 1)
+        {
+            return glyph[0] >= 0x20 && glyph[0] < 0x7F;
+        }
+        if (glyph.size() != 3)
+        {
+            return false;
+        }
+        auto byte0 = static_cast<uint8_t>(glyph[0]);
+        auto byte1 = static_cast<uint8_t>(glyph[1]);
+        /** U+2500 - U+259F */
+        bool boxOrBlock = byte0 == 0xE2 && (byte1 == 0x94 || byte1 == 0x95 || byte1 == 0x96);
+        /** U+2800 - U+28FF */
+        bool braille = byte0 == 0xE2 && (byte1 == 0xA0 || byte1 == 0xA1 || byte1 == 0xA2 || byte1 == 0xA3);
+        return boxOrBlock || braille;
+    }
+
+    /** The length of CSI n <final> */
+    size_t GetSequenceLength(size_t n)
+    {
+        return 3 + std::to_string(n).size();
+    }
+}
+
+void Console::Encode(std::string& output, const std::string_view& str, size_t column, bool canErase) const
+{
+    bool columnKnown = true;
+    size_t i = 0;
+    while (i < str.size())
+    {
+        auto length = std::min(GetUtf8Length(str[i]), str.size() - i);
+        auto glyph = str.substr(i, length);
+        size_t count = 1;
+        while (i + (count + 1)*length <= str.size() && str.substr(i + count*length, length) == glyph)
+        {
+            count++;
+        }
+        i += count*length;
+        bool narrow = IsNarrow(glyph);
+        bool more = i < str.size();
+        /** ECH and EL leave the cursor where it is */
+        size_t skip = more ? GetSequenceLength(count) : 0;
+        bool toLineEnd = columnKnown && column + count >= _width;
+        if (glyph == " " && canErase && _canErase && toLineEnd && 3 + skip < count)
+        {
+            output += "\x1b[K";
+            if (more)
+            {
+                output += "\x1b[" + std::to_string(count) + "C";
+            }
+        }
+        else if (glyph == " " && canErase && _canErase && GetSequenceLength(count) + skip < count)
+        {
+            output += "\x1b[" + std::to_string(count) + "X";
+            if (more)
+            {
+                output += "\x1b[" + std::to_string(count) + "C";
+            }
+        }
+        else if (narrow && _canRepeat && count > 1 && GetSequenceLength(count - 1) < (count - 1)*length)
+        {
+            output += glyph;
+            output += "\x1b[" + std::to_string(count - 1) + "b";
+        }
+        else
+        {
+            for (size_t n = 0; n < count; n++)
+            {
+                output += glyph;
+            }
+        }
+        if (glyph == "\n")
+        {
+            column = 0;
+            columnKnown = true;
+        }
+        else if (narrow)
+        {
+            column += count;
+        }
+        else
+        {
+            columnKnown = false;
+        }
+    }
+}
+
+void Console::DetectCapabilities()
+{
+    /** ECH and EL are in every terminal that is not dumb */
+    const char* term = std::getenv("TERM");
+    std::string_view name = term != nullptr ? term : "";
+    _canErase = !name.empty() && name != "dumb";
+    if (_canErase)
+    {
+        /** 
+         * Ask for the state of synchronized updates (DECRQM),
+         * the answer comes back as input. Terminals without DECRQM ignore it.
+         * REP is in ECMA-48 but the Linux console and screen do not have it,
+         * so it stays off until the probe shows the cursor moved past the repeats.
+         */
+        std::cout << "\x1b[?2026$p" << REPEAT_PROBE;
+        std::flush(std::cout);
+    }
+}
+
+void Console::ScrollRegion(size_t top, size_t bottom, int lines)
+{
+    if (lines == 0)
+    {
+        return;
+    }
+    _foreground = ForegroundColor::Default;
+    _background = BackgroundColor::Default;
+    std::string output = "\x1b[" + std::to_string(top + 1) + ";" + std::to_string(bottom + 1) + "r"
+        "\x1b[39m"
+        "\x1b[49m";
+    if (lines > 0)
+    {
+        output += "\x1b[" + std::to_string(lines) + "S";
+    }
+    else
+    {
+        output += "\x1b[" + std::to_string(-lines) + "T";
+    }
+    /** Reset the scroll region to the full screen */
+    output += "\x1b[r";
+    Write(output);
 }
@@ -62,11 +62,16 @@ namespace Snake
             Down,
             Left,
             Right,
+            PageUp,
+            PageDown,
+            Home,
+            End,
         };
 
         typedef std::function<void()> KeyHandler;
         typedef std::function<void(const std::string_view&)> StringHandler;
         typedef std::function<void(const std::string_view&)> ErrorHandler;
+        typedef std::function<void()> ResizeHandler;
 
         Console(Tev& tev);
         ~Console();
@@ -78,6 +83,12 @@ namespace Snake
 
         void Close();
         void Clear();
+        /**
+         * @brief Collect the output until the matching EndFrame,
+         *      then write it out at once. Frames can be nested.
+         */
+        void BeginFrame();
+        void EndFrame();
         /**
          * @brief Put a string to the display.
          * 
@@ -91,13 +102,55 @@ namespace Snake
             ForegroundColor foreGround = ForegroundColor::Default,
             BackgroundColor backGround = BackgroundColor::Default);
 
+        /**
+         * @brief Scroll the lines between top and bottom (inclusive).
+         * 
+         * @param top 
+         * @param bottom 
+         * @param lines Positive scrolls the content up, negative scrolls it down.
+         *      Lines scrolled in are blank.
+         */
+        void ScrollRegion(size_t top, size_t bottom, int lines);
+
         void SetKeyHandler(char key, KeyHandler handler);
         void SetKeyHandler(EscapedKeys key, KeyHandler handler);
 
         void GetString(size_t x, size_t y, size_t maxLength, StringHandler handler);
 
         void SetErrorHandler(ErrorHandler handler);
+
+        /** Columns of the terminal, never less than Constants::DISPLAY_WIDTH */
+        size_t GetWidth() const;
+        /** Rows of the terminal, never less than Constants::DISPLAY_HEIGHT */
+        size_t GetHeight() const;
+        /**
+         * @brief Tell the console the terminal may have been resized.
+         *      The size is checked once the calls stop for a moment,
+         *      so dragging a window redraws once.
+         */
+        void NotifyResize();
+        /**
+         * @brief Set the handler to lay the screen out again after a resize.
+         *      The screen is cleared before it is called.
+         * 
+         * @param handler 
+         */
+        void SetResizeHandler(ResizeHandler handler);
     private:
+        /** How long the size has to be stable before the screen is redrawn */
+        static constexpr int RESIZE_DELAY_MS = 50;
+        /** Start of the DECRQM answer for synchronized updates (mode 2026) */
+        static constexpr std::string_view SYNCHRONIZED_UPDATE_REPORT{"\x1b[?2026;"};
+        /**
+         * Write a character at column 20 and ask REP for three more, then ask where the cursor is (CPR).
+         * The column is past the ones a function key with modifiers reports as.
+         */
+        static constexpr std::string_view REPEAT_PROBE{"\x1b[1;20Ha\x1b[3b\x1b[6n\x1b[1;20H    "};
+        /** The cursor moved past the repeated characters */
+        static constexpr std::string_view REPEAT_REPORT{"\x1b[1;24R"};
+        /** REP was ignored */
+        static constexpr std::string_view NO_REPEAT_REPORT{"\x1b[1;21R"};
+
         struct StringInputState
         {
             std::string input{};
@@ -108,13 +161,42 @@ namespace Snake
 
         Tev& _tev;
         bool _closed{false};
+        int _frameDepth{0};
+        std::string _frame{};
+        /** Colors currently set on the terminal, to skip redundant escapes */
+        std::optional<ForegroundColor> _foreground{};
+        std::optional<BackgroundColor> _background{};
         ErrorHandler _errorHandler{nullptr};
+        ResizeHandler _resizeHandler{nullptr};
+        Tev::Timeout _resizeTimer{};
+        size_t _width{0};
+        size_t _height{0};
+        /** The terminal answered the REP probe, to repeat the last character */
+        bool _canRepeat{false};
+        /** The terminal has ECH and EL, to blank characters without writing spaces */
+        bool _canErase{false};
+        /** The terminal has synchronized updates, to show each frame at once */
+        bool _canSynchronize{false};
         std::unordered_map<std::string, KeyHandler> _keyHandlers{};
         StringHandler _stringHandler{nullptr};
         std::deque<char> _inputBuffer{};
         StringInputState _inputString{};
         Tev::FdHandler _readHandler{};
 
+        void Write(const std::string_view& str);
+        /**
+         * @brief Append text to the output, with runs of the same character
+         *      repeated by REP and runs of blanks erased by ECH or EL when shorter.
+         * 
+         * @param output 
+         * @param str 
+         * @param column Where the text starts.
+         * @param canErase false if erasing would not give the same background.
+         */
+        void Encode(std::string& output, const std::string_view& str, size_t column, bool canErase) const;
+        void DetectCapabilities();
+        /** @return true if the size changed */
+        bool UpdateSize();
         void TerminalKeyHandler();
         void TerminalStringHandler();
     };
@@ -1,16 +1,27 @@
 #pragma once
 
+#include <stdint.h>
+#include <string_view>
+
 namespace Snake
 {
     namespace Constants
     {
+        /** The smallest terminal the screens are laid out for */
         constexpr int DISPLAY_WIDTH = 80;
         constexpr int DISPLAY_HEIGHT = 25;
         constexpr std::string_view SAVE_FILE_ROOT = ".terminal_snake";
         constexpr std::string_view LEADER_BOARD_FILE = "leaderboard.json";
-        constexpr int LEADER_BOARD_SIZE = 10;
-        /** This is not a least upper bound */
-        constexpr int SCORE_UPPER_BOUND = 99999;
+        constexpr int LEADER_BOARD_SIZE = 1000;
+        /** A snake filling the largest board, GameEngine::MAX_SIZE squared */
+        constexpr int SCORE_UPPER_BOUND = 4096 * 4096;
         constexpr std::string_view SETTINGS_FILE = "settings.json";
+        constexpr std::string_view REPLAY_DIRECTORY = "replays";
+        constexpr std::string_view SAVE_GAME_FILE = "savegame.bin";
+        /** Level files, see Level.h */
+        constexpr std::string_view LEVEL_DIRECTORY = "levels";
+        constexpr std::string_view LEVEL_EXTENSION = ".level";
+        /** Snapshot a running game every this many ticks, to survive a crash */
+        constexpr uint32_t CHECKPOINT_INTERVAL = 25;
     }
 }
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include "DistanceField.h"
+
+using namespace Snake;
+
+void DistanceField::Reset(const GameEngine& engine)
+{
+    Grid grid{engine};
+    if (!(grid == _grid))
+    {
+        _grid = grid;
+        _cells.assign(_grid.GetSize(), 0);
+        _version = 0;
+        /** The wave ends up holding every free cell, growing it mid rebuild would stall a tick */
+        _wave.reserve(_grid.GetSize());
+    }
+    _food = engine.ToIndex(engine.GetFood());
+    Rebuild(engine);
+}
+
+void DistanceField::Rebuild(const GameEngine&)
+{
+    if (++_version > UINT8_MAX)
+    {
+        /** Once every 255 rebuilds */
+        std::fill(_cells.begin(), _cells.end(), 0);
+        _version = 1;
+    }
+    Set(_food, 0);
+    _wave.clear();
+    _wave.push_back(_food);
+    _next = 0;
+    _complete = false;
+    _touched.clear();
+}
+
+void DistanceField::Touch(const GameEngine& engine, uint32_t cell)
+{
+    if (!_complete)
+    {
+        _touched.push_back(cell);
+        return;
+    }
+    Refresh(engine, cell);
+}
+
+bool DistanceField::Update(const GameEngine& engine, uint32_t budget)
+{
+    if (_complete)
+    {
+        return true;
+    }
+    for (uint32_t visited = 0; visited < budget && _next < _wave.size(); visited++)
+    {
+        auto cell = _wave[_next++];
+        auto distance = Get(cell) + 1;
+        for (auto direction : Grid::DIRECTIONS)
+        {
+            auto next = _grid.Neighbor(cell, direction);
+            if (Get(next) == UNREACHABLE && Grid::IsFree(engine, next))
+            {
+                Set(next, distance);
+                _wave.push_back(next);
+            }
+        }
+    }
+    if (_next < _wave.size())
+    {
+        return false;
+    }
+    _complete = true;
+    _wave.clear();
+    /**
+     * The rebuild saw each cell as it was when it got there.
+     * Cells changed on the way are looked at again as they are now.
+     */
+    for (size_t i = 0; i < _touched.size() && _complete; i++)
+    {
+        Refresh(engine, _touched[i]);
+    }
+    if (!_complete)
+    {
+        /** One of them started the rebuild over */
+        return false;
+    }
+    _touched.clear();
+    return true;
+}
+
+bool DistanceField::IsComplete() const
+{
+    return _complete;
+}
+
+uint32_t DistanceField::GetFood() const
+{
+    return _food;
+}
+
+uint32_t DistanceField::Get(uint32_t cell) const
+{
+    auto value = _cells[cell];
+    if ((value >> DISTANCE_BITS) != _version || (value & DISTANCE_MASK) == DISTANCE_MASK)
+    {
+        return UNREACHABLE;
+    }
+    return value & DISTANCE_MASK;
+}
+
+std::optional<GameEngine::Direction> DistanceField::Descend(const GameEngine& engine) const
+{
+    if (!_complete)
+    {
+        return std::nullopt;
+    }
+    auto head = engine.ToIndex(engine.GetSnake().front());
+    std::optional<GameEngine::Direction> closest{};
+    uint32_t closestDistance = UNREACHABLE;
+    for (auto direction : Grid::DIRECTIONS)
+    {
+        auto next = _grid.Neighbor(head, direction);
+        auto distance = Get(next);
+        if (distance < closestDistance && Grid::IsFree(engine, next))
+        {
+            closestDistance = distance;
+            closest = direction;
+        }
+    }
+    return closest;
+}
+
+void DistanceField::Set(uint32_t cell, uint32_t distance)
+{
+    /** A path is shorter than the board, so a distance never takes the mask */
+    _cells[cell] = (_version << DISTANCE_BITS) | std::min(distance, DISTANCE_MASK);
+}
+
+void DistanceField::Refresh(const GameEngine& engine, uint32_t cell)
+{
+    bool done = true;
+    if (!Grid::IsFree(engine, cell))
+    {
+        done = Raise(engine, cell);
+    }
+    else if (cell != _food)
+    {
+        auto distance = GetFromNeighbors(cell);
+        if (distance < Get(cell))
+        {
+            Set(cell, distance);
+            _queue.clear();
+            _queue.push_back(cell);
+            done = Lower(engine);
+        }
+    }
+    if (!done)
+    {
+        /** Cheaper to start over, and that can be spread over ticks */
+        Rebuild(engine);
+    }
+}
+
+bool DistanceField::Raise(const GameEngine& engine, uint32_t cell)
+{
+    auto distance = Get(cell);
+    if (distance == UNREACHABLE)
+    {
+        return true;
+    }
+    Set(cell, UNREACHABLE);
+    /**
+     * A neighbor one step further away lost its way to the food,
+     * unless another of its neighbors is as close as the cell was.
+     * The cells are found closest first, so the other ways are known lost
+     * by the time they are looked at.
+     */
+    _lost.clear();
+    _lost.emplace_back(cell, distance);
+    for (size_t i = 0; i < _lost.size(); i++)
+    {
+        if (_lost.size() > UPDATE_BUDGET)
+        {
+            return false;
+        }
+        auto [lostCell, lostDistance] = _lost[i];
+        for (auto direction : Grid::DIRECTIONS)
+        {
+            auto next = _grid.Neighbor(lostCell, direction);
+            if (Get(next) != lostDistance + 1)
+            {
+                continue;
+            }
+            bool otherWay = false;
+            for (auto around : Grid::DIRECTIONS)
+            {
+                if (Get(_grid.Neighbor(next, around)) == lostDistance)
+                {
+                    otherWay = true;
+                    break;
+                }
+            }
+            if (!otherWay)
+            {
+                Set(next, UNREACHABLE);
+                _lost.emplace_back(next, lostDistance + 1);
+            }
+        }
+    }
+    /** Start again from the edge of what is left, closest first */
+    _queue.clear();
+    for (const auto& [lostCell, lostDistance] : _lost)
+    {
+        if (!Grid::IsFree(engine, lostCell))
+        {
+            continue;
+        }
+        auto fromNeighbors = GetFromNeighbors(lostCell);
+        if (fromNeighbors != UNREACHABLE)
+        {
+            Set(lostCell, fromNeighbors);
+            _queue.push_back(lostCell);
+        }
+    }
+    std::sort(_queue.begin(), _queue.end(), [this](uint32_t a, uint32_t b){
+        return Get(a) < Get(b);
+    });
+    return Lower(engine);
+}
+
+bool DistanceField::Lower(const GameEngine& engine)
+{
+    for (size_t i = 0; i < _queue.size(); i++)
+    {
+        if (_queue.size() > UPDATE_BUDGET)
+        {
+            return false;
+        }
+        auto cell = _queue[i];
+        auto distance = Get(cell) + 1;
+        for (auto direction : Grid::DIRECTIONS)
+        {
+            auto next = _grid.Neighbor(cell, direction);
+            if (distance < Get(next) && Grid::IsFree(engine, next))
+            {
+                Set(next, distance);
+                _queue.push_back(next);
+            }
+        }
+    }
+    return true;
+}
+
+uint32_t DistanceField::GetFromNeighbors(uint32_t cell) const
+{
+    uint32_t closest = UNREACHABLE;
+    for (auto direction : Grid::DIRECTIONS)
+    {
+        closest = std::min(closest, Get(_grid.Neighbor(cell, direction)));
+    }
+    return closest == UNREACHABLE ? UNREACHABLE : closest + 1;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "GameEngine.h"
+#include "Grid.h"
+
+namespace Snake
+{
+    /**
+     * @brief Steps from every free cell to the food, kept up to date as the snake moves.
+     *      New food starts a breadth first rebuild that can be spread over several ticks.
+     *      After that, only the cells whose distance depends on a changed cell are updated.
+     *      A change that reaches more than UPDATE_BUDGET cells starts a rebuild instead,
+     *      so one tick never costs more than that.
+     */
+    class DistanceField
+    {
+    public:
+        static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+        /** Cells one update may change */
+        static constexpr size_t UPDATE_BUDGET = 1 << 14;
+
+        DistanceField() = default;
+        ~DistanceField() = default;
+
+        /**
+         * @brief Start a rebuild for the food of the game.
+         *      Buffers are only sized again when the board size changes.
+         *
+         * @param engine
+         */
+        void Reset(const GameEngine& engine);
+        /**
+         * @brief A cell may have been taken or freed since the last update.
+         *      During a rebuild it is kept until the rebuild is done.
+         *
+         * @param engine
+         * @param cell
+         */
+        void Touch(const GameEngine& engine, uint32_t cell);
+        /**
+         * @brief Continue the rebuild.
+         *
+         * @param budget Cells the rebuild may visit in this call.
+         * @return true if the field is complete.
+         */
+        bool Update(const GameEngine& engine, uint32_t budget);
+        bool IsComplete() const;
+        uint32_t GetFood() const;
+        uint32_t Get(uint32_t cell) const;
+        /**
+         * @brief The way from the head to the closest free neighbor.
+         *
+         * @return nothing if the food cannot be reached or the field is not complete.
+         */
+        std::optional<GameEngine::Direction> Descend(const GameEngine& engine) const;
+
+    private:
+        /** A cell is its distance in the low 24 bits and the version in the high 8 */
+        static constexpr uint32_t DISTANCE_BITS = 24;
+        static constexpr uint32_t DISTANCE_MASK = (1 << DISTANCE_BITS) - 1;
+        static_assert(static_cast<uint32_t>(GameEngine::MAX_SIZE) * GameEngine::MAX_SIZE <= DISTANCE_MASK + 1);
+
+        Grid _grid{};
+        uint32_t _food{UINT32_MAX};
+        /**
+         * Distances and versions in one table, a lookup is one load.
+         * Cells of older versions are unreachable, so a rebuild clears nothing.
+         */
+        std::vector<uint32_t> _cells{};
+        uint32_t _version{0};
+        /** Cells of the rebuild still to visit, from _next on */
+        std::vector<uint32_t> _wave{};
+        size_t _next{0};
+        bool _complete{false};
+        /** Cells changed during the rebuild */
+        std::vector<uint32_t> _touched{};
+        /** Update buffers */
+        std::vector<uint32_t> _queue{};
+        /** Cells that lost their distance, with the distance they had */
+        std::vector<std::pair<uint32_t, uint32_t>> _lost{};
+
+        void Set(uint32_t cell, uint32_t distance);
+        void Rebuild(const GameEngine& engine);
+        /** Bring the field in line with a cell that was taken or freed */
+        void Refresh(const GameEngine& engine, uint32_t cell);
+        /**
+         * @brief The cell was taken, everything that got to the food through it is found again.
+         *
+         * @return false if it went over the budget.
+         */
+        bool Raise(const GameEngine& engine, uint32_t cell);
+        /**
+         * @brief Pass shorter distances on from the cells in _queue.
+         *
+         * @return false if it went over the budget.
+         */
+        bool Lower(const GameEngine& engine);
+        /** One more than the closest neighbor */
+        uint32_t GetFromNeighbors(uint32_t cell) const;
+    };
+}
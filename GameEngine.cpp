@@ -0,0 +1,875 @@
+#include <stdexcept>
+#include <algorithm>
+#include <bit>
+#include "GameEngine.h"
+#include "BinaryIO.h"
+#include "Geometry.h"
+
+using namespace Snake;
+
+namespace
+{
+    /** Up to 64 bits of a plane from a bit index, which do not go past its end */
+    uint64_t GetBits(std::span<const uint64_t> plane, size_t start, uint32_t count)
+    {
+        size_t word = start / 64;
+        auto offset = static_cast<uint32_t>(start % 64);
+        uint64_t bits = plane[word] >> offset;
+        if (offset != 0 && offset + count > 64)
+        {
+            bits |= plane[word + 1] << (64 - offset);
+        }
+        return count >= 64 ? bits : bits & ((uint64_t{1} << count) - 1);
+    }
+
+    /** A snake segment as it is saved */
+    struct Segment
+    {
+        uint32_t index;
+        uint8_t type;
+    } __attribute__((packed));
+}
+
+GameEngine::GameEngine(int width, int height)
+    : GameEngine(Level::Open(width, height))
+{
+}
+
+GameEngine::GameEngine(const Level& level)
+    : GameEngine(CompiledLevel::Compile(level))
+{
+}
+
+GameEngine::GameEngine(std::shared_ptr<const CompiledLevel> level)
+    : _width(level->GetWidth()),
+      _height(level->GetHeight()),
+      _level(std::move(level))
+{
+    if (_width < MIN_WIDTH || _height < 1 || _width > MAX_SIZE || _height > MAX_SIZE)
+    {
+        throw std::invalid_argument("Invalid board size");
+    }
+    _step = SelectStep(_level->GetEdges());
+}
+
+void GameEngine::Reset(uint64_t seed)
+{
+    _finished = false;
+    _tick = 0;
+    /** Clear cells */
+    _board.Reset(static_cast<uint32_t>(_width), static_cast<uint32_t>(_height), GetEdges() == Level::Edges::Wrap);
+    _board.SetWalls(_level->GetWalls());
+    _emptyCells.Reset(static_cast<uint32_t>(_width * _height));
+    _emptyCells.Seed(seed);
+    /** Column by column, the pool order decides where the food shows up */
+    _emptyCells.Fill(_level->GetFreeColumns(), static_cast<uint32_t>(_width), static_cast<uint32_t>(_height));
+    /** Put the snake from its tail to its head, the level made sure the cells are free */
+    auto spawn = _level->GetSpawn(seed % _level->GetSpawnCount());
+    auto direction = static_cast<Direction>(spawn.direction);
+    DynamicGeometry geometry{_width, _height};
+    auto position = ToCoordinate(spawn.head);
+    for (int i = 1; i < Level::SPAWN_LENGTH; i++)
+    {
+        geometry.Move<WrapEdges>(position, OppositeDirection(direction));
+    }
+    _snake.clear();
+    for (int i = 0; i < Level::SPAWN_LENGTH; i++)
+    {
+        if (i > 0)
+        {
+            geometry.Move<WrapEdges>(position, direction);
+        }
+        _snake.push_front(position);
+        _board.Take(ToIndex(position), static_cast<uint8_t>(direction));
+        _emptyCells.Remove(ToIndex(position));
+    }
+    _direction = direction;
+    _pendingDirection = direction;
+    /** reset score */
+    _score = 0;
+    /** Generate the initial food */
+    _food = ToCoordinate(_emptyCells.PopRandom());
+}
+
+void GameEngine::SetDirection(Direction direction)
+{
+    if (_direction == OppositeDirection(direction))
+    {
+        return;
+    }
+    _pendingDirection = direction;
+}
+
+GameEngine::StepResult GameEngine::Step()
+{
+    if (_finished)
+    {
+        throw std::logic_error("Game is finished");
+    }
+    return (this->*_step)();
+}
+
+GameEngine::StepFunction GameEngine::SelectStep(Level::Edges edges)
+{
+    switch (edges)
+    {
+    case Level::Edges::Wrap:
+        return &GameEngine::StepOn<WrapEdges>;
+    case Level::Edges::Solid:
+        return &GameEngine::StepOn<SolidEdges>;
+    default:
+        throw std::invalid_argument("Invalid level edges");
+    }
+}
+
+template <typename Edges>
+GameEngine::StepResult GameEngine::StepOn()
+{
+    DynamicGeometry geometry{_width, _height};
+    _tick++;
+    auto head = _snake.front();
+    StepResult result{};
+    result.delta.direction = _direction;
+    _direction = _pendingDirection;
+    Coordinate nextHead = head;
+    bool inside = geometry.Move<Edges>(nextHead, _direction);
+    result.head = nextHead;
+    auto nextIndex = geometry.ToIndex(nextHead);
+    result.delta.head = nextIndex;
+    if (!inside || !_board.IsFree(nextIndex))
+    {
+        _finished = true;
+        result.outcome = Outcome::Dead;
+        result.delta.outcome = result.outcome;
+        return result;
+    }
+    if (nextIndex == geometry.ToIndex(_food))
+    {
+        _score++;
+        result.outcome = Outcome::Ate;
+    }
+    else
+    {
+        auto tail = _snake.back();
+        auto tailIndex = geometry.ToIndex(tail);
+        result.delta.tail = tailIndex;
+        result.delta.tailType = SnakeCellType(static_cast<Direction>(_board.GetDirection(tailIndex)));
+        _board.Free(tailIndex);
+        _emptyCells.Insert(tailIndex);
+        _snake.pop_back();
+        _emptyCells.Remove(nextIndex);
+        result.tail = tail;
+        result.outcome = Outcome::Moved;
+    }
+    _board.Take(nextIndex, static_cast<uint8_t>(_direction));
+    _snake.push_front(nextHead);
+    if (result.outcome == Outcome::Ate)
+    {
+        if (_emptyCells.Empty())
+        {
+            _finished = true;
+            result.outcome = Outcome::Won;
+            result.delta.outcome = result.outcome;
+            return result;
+        }
+        auto food = _emptyCells.PopRandom();
+        _food = geometry.ToCoordinate(food);
+        result.food = _food;
+        result.delta.food = food;
+    }
+    result.delta.outcome = result.outcome;
+    return result;
+}
+
+void GameEngine::Undo(const TickDelta& delta)
+{
+    if (_tick == 0 || delta.head >= static_cast<uint32_t>(_width * _height))
+    {
+        throw std::logic_error("Nothing to undo");
+    }
+    _tick--;
+    _direction = delta.direction;
+    _pendingDirection = delta.direction;
+    _finished = false;
+    if (delta.outcome == Outcome::Dead)
+    {
+        /** A fatal step only moved the clock */
+        return;
+    }
+    auto head = ToCoordinate(delta.head);
+    if (_snake.empty() || !(_snake.front() == head))
+    {
+        throw std::logic_error("Delta does not match the last step");
+    }
+    _snake.pop_front();
+    if (delta.outcome == Outcome::Moved)
+    {
+        _board.Free(delta.head);
+        _emptyCells.Insert(delta.head);
+        _board.Take(delta.tail, static_cast<uint8_t>(SnakeCellDirection(delta.tailType)));
+        _emptyCells.Remove(delta.tail);
+        _snake.push_back(ToCoordinate(delta.tail));
+        return;
+    }
+    /** Ate or won, put the eaten food back */
+    _score--;
+    if (delta.food != TickDelta::NO_CELL)
+    {
+        _emptyCells.Insert(delta.food);
+    }
+    _board.Free(delta.head);
+    _food = head;
+}
+
+void GameEngine::Redo(const TickDelta& delta)
+{
+    if (_finished || delta.head >= static_cast<uint32_t>(_width * _height))
+    {
+        throw std::logic_error("Nothing to redo");
+    }
+    auto head = ToCoordinate(delta.head);
+    auto previousHead = _snake.front();
+    /** The step the engine took, only a fatal one goes past a solid edge */
+    DynamicGeometry geometry{_width, _height};
+    bool wraps = GetEdges() == Level::Edges::Wrap;
+    std::optional<Direction> direction{};
+    for (auto candidate : {Direction::Up, Direction::Down, Direction::Left, Direction::Right})
+    {
+        auto next = previousHead;
+        bool inside = wraps
+            ? geometry.Move<WrapEdges>(next, candidate)
+            : geometry.Move<SolidEdges>(next, candidate);
+        if (next == head && (inside || delta.outcome == Outcome::Dead))
+        {
+            direction = candidate;
+            break;
+        }
+    }
+    if (!direction.has_value())
+    {
+        throw std::logic_error("Delta does not match the next step");
+    }
+    _tick++;
+    _direction = direction.value();
+    _pendingDirection = _direction;
+    if (delta.outcome == Outcome::Dead)
+    {
+        _finished = true;
+        return;
+    }
+    if (delta.outcome == Outcome::Moved)
+    {
+        _board.Free(delta.tail);
+        _emptyCells.Insert(delta.tail);
+        _snake.pop_back();
+        _emptyCells.Remove(delta.head);
+    }
+    else
+    {
+        _score++;
+    }
+    _board.Take(delta.head, static_cast<uint8_t>(_direction));
+    _snake.push_front(head);
+    if (delta.outcome == Outcome::Won)
+    {
+        _finished = true;
+    }
+    else if (delta.outcome == Outcome::Ate)
+    {
+        _emptyCells.Remove(delta.food);
+        _food = ToCoordinate(delta.food);
+    }
+}
+
+void GameEngine::Serialize(std::ostream& output) const
+{
+    if (_finished)
+    {
+        throw std::logic_error("Game is finished");
+    }
+    auto index = [this](const Coordinate& c){
+        return ToIndex(c);
+    };
+    BinaryIO::Write(output, STATE_MAGIC);
+    BinaryIO::Write(output, STATE_VERSION);
+    BinaryIO::Write(output, static_cast<int32_t>(_width));
+    BinaryIO::Write(output, static_cast<int32_t>(_height));
+    BinaryIO::Write(output, GetEdges());
+    /** Written in chunks, one stream call per value is the bulk of the cost */
+    constexpr size_t CHUNK = 256;
+    uint32_t indices[CHUNK];
+    size_t count = 0;
+    auto writeIndex = [&](uint32_t cell){
+        indices[count++] = cell;
+        if (count == CHUNK)
+        {
+            output.write(reinterpret_cast<const char*>(indices), sizeof(uint32_t) * count);
+            count = 0;
+        }
+    };
+    BinaryIO::Write(output, static_cast<uint32_t>(_level->GetWallCount()));
+    _level->ForEachWall(writeIndex);
+    output.write(reinterpret_cast<const char*>(indices), sizeof(uint32_t) * count);
+    count = 0;
+    BinaryIO::Write(output, static_cast<uint32_t>(_level->GetSpawnCount()));
+    for (size_t i = 0; i < _level->GetSpawnCount(); i++)
+    {
+        auto spawn = _level->GetSpawn(i);
+        BinaryIO::Write(output, spawn.head);
+        BinaryIO::Write(output, spawn.direction);
+    }
+    BinaryIO::Write(output, _tick);
+    BinaryIO::Write(output, static_cast<int32_t>(_score));
+    BinaryIO::Write(output, _direction);
+    BinaryIO::Write(output, _pendingDirection);
+    BinaryIO::Write(output, index(_food));
+    BinaryIO::Write(output, _emptyCells.GetRandomState());
+    WriteSnake(output);
+    /** The pool order decides where the next food shows up */
+    const auto& empty = _emptyCells.Values();
+    BinaryIO::Write(output, static_cast<uint32_t>(empty.size()));
+    for (auto cell : empty)
+    {
+        writeIndex(cell);
+    }
+    output.write(reinterpret_cast<const char*>(indices), sizeof(uint32_t) * count);
+}
+
+void GameEngine::Deserialize(std::istream& input)
+{
+    auto fail = [](){
+        throw std::runtime_error("Invalid game state");
+    };
+    auto validDirection = [](Direction direction){
+        return static_cast<uint8_t>(direction) <= static_cast<uint8_t>(Direction::Right);
+    };
+    if (BinaryIO::Read<uint32_t>(input) != STATE_MAGIC)
+    {
+        fail();
+    }
+    auto version = BinaryIO::Read<uint32_t>(input);
+    if (version < 1 || version > STATE_VERSION)
+    {
+        fail();
+    }
+    auto width = BinaryIO::Read<int32_t>(input);
+    auto height = BinaryIO::Read<int32_t>(input);
+    if (width < MIN_WIDTH || height < 1 || width > MAX_SIZE || height > MAX_SIZE)
+    {
+        fail();
+    }
+    uint32_t cellCount = static_cast<uint32_t>(width * height);
+    Level level{"", width, height, Level::Edges::Wrap, {}, {}};
+    if (version >= 2)
+    {
+        level.edges = BinaryIO::Read<Level::Edges>(input);
+        auto wallCount = BinaryIO::Read<uint32_t>(input);
+        if (static_cast<uint8_t>(level.edges) > static_cast<uint8_t>(Level::Edges::Solid) ||
+            wallCount >= cellCount)
+        {
+            fail();
+        }
+        level.walls.resize(wallCount);
+        input.read(reinterpret_cast<char*>(level.walls.data()), sizeof(uint32_t) * wallCount);
+        if (!input)
+        {
+            throw std::runtime_error("File is truncated");
+        }
+    }
+    if (version >= 3)
+    {
+        auto spawnCount = BinaryIO::Read<uint32_t>(input);
+        if (spawnCount == 0 || spawnCount > cellCount)
+        {
+            fail();
+        }
+        level.spawns.resize(spawnCount);
+        for (auto& spawn : level.spawns)
+        {
+            spawn.head = BinaryIO::Read<uint32_t>(input);
+            spawn.direction = BinaryIO::Read<uint8_t>(input);
+        }
+    }
+    else
+    {
+        level.spawns.push_back(Level::GetDefaultSpawn(width, height));
+    }
+    /** Checks the walls and the spawns */
+    auto compiled = CompiledLevel::Compile(level);
+    auto coordinate = [width, cellCount, &fail](uint32_t index){
+        if (index >= cellCount)
+        {
+            fail();
+        }
+        return Coordinate{static_cast<int>(index % width), static_cast<int>(index / width)};
+    };
+    /** Build everything aside, and only take it if it is consistent */
+    auto tick = BinaryIO::Read<uint32_t>(input);
+    auto score = BinaryIO::Read<int32_t>(input);
+    auto direction = BinaryIO::Read<Direction>(input);
+    auto pendingDirection = BinaryIO::Read<Direction>(input);
+    auto food = coordinate(BinaryIO::Read<uint32_t>(input));
+    auto randomState = BinaryIO::Read<Random::State>(input);
+    if (score < 0 || !validDirection(direction) || !validDirection(pendingDirection))
+    {
+        fail();
+    }
+    Bitboard board{};
+    board.Reset(static_cast<uint32_t>(width), static_cast<uint32_t>(height), level.edges == Level::Edges::Wrap);
+    board.SetWalls(compiled->GetWalls());
+    uint32_t foodIndex = static_cast<uint32_t>(food.x + food.y*width);
+    if (!board.IsFree(foodIndex))
+    {
+        fail();
+    }
+    auto snakeLength = BinaryIO::Read<uint32_t>(input);
+    if (snakeLength == 0 || snakeLength >= cellCount - level.walls.size())
+    {
+        fail();
+    }
+    std::deque<Coordinate> snake{};
+    for (uint32_t i = 0; i < snakeLength; i++)
+    {
+        auto segment = coordinate(BinaryIO::Read<uint32_t>(input));
+        auto type = static_cast<CellType>(BinaryIO::Read<uint8_t>(input));
+        auto cell = static_cast<uint32_t>(segment.x + segment.y*width);
+        if (!board.IsFree(cell) || cell == foodIndex ||
+            type < CellType::SnakeRight || type > CellType::SnakeDown)
+        {
+            fail();
+        }
+        board.Take(cell, static_cast<uint8_t>(SnakeCellDirection(type)));
+        snake.push_back(segment);
+    }
+    auto emptyCount = BinaryIO::Read<uint32_t>(input);
+    if (emptyCount != cellCount - level.walls.size() - snakeLength - 1)
+    {
+        fail();
+    }
+    std::vector<uint32_t> indices(emptyCount);
+    input.read(reinterpret_cast<char*>(indices.data()), sizeof(uint32_t) * emptyCount);
+    if (!input)
+    {
+        throw std::runtime_error("File is truncated");
+    }
+    RandomPool emptyCells{};
+    emptyCells.Reset(cellCount);
+    for (auto cell : indices)
+    {
+        if (cell >= cellCount || !board.IsFree(cell) || cell == foodIndex)
+        {
+            fail();
+        }
+        emptyCells.Insert(cell);
+    }
+    if (emptyCells.Size() != emptyCount)
+    {
+        fail();
+    }
+    emptyCells.SetRandomState(randomState);
+    _width = width;
+    _height = height;
+    _level = std::move(compiled);
+    _step = SelectStep(_level->GetEdges());
+    _tick = tick;
+    _score = score;
+    _direction = direction;
+    _pendingDirection = pendingDirection;
+    _finished = false;
+    _food = food;
+    _board = std::move(board);
+    _snake = std::move(snake);
+    _emptyCells = std::move(emptyCells);
+}
+
+void GameEngine::WriteSnapshot(std::ostream& output) const
+{
+    if (_finished)
+    {
+        throw std::logic_error("Game is finished");
+    }
+    BinaryIO::Write(output, SNAPSHOT_MAGIC);
+    BinaryIO::Write(output, SNAPSHOT_VERSION);
+    BinaryIO::Write(output, static_cast<int32_t>(_width));
+    BinaryIO::Write(output, static_cast<int32_t>(_height));
+    BinaryIO::Write(output, _tick);
+    BinaryIO::Write(output, static_cast<int32_t>(_score));
+    BinaryIO::Write(output, _direction);
+    BinaryIO::Write(output, _pendingDirection);
+    BinaryIO::Write(output, ToIndex(_food));
+    BinaryIO::Write(output, _emptyCells.GetRandomState());
+    WriteSnake(output);
+}
+
+void GameEngine::ReadSnapshot(std::istream& input)
+{
+    auto fail = [](){
+        throw std::runtime_error("Invalid game snapshot");
+    };
+    auto validDirection = [](Direction direction){
+        return static_cast<uint8_t>(direction) <= static_cast<uint8_t>(Direction::Right);
+    };
+    if (BinaryIO::Read<uint32_t>(input) != SNAPSHOT_MAGIC ||
+        BinaryIO::Read<uint32_t>(input) != SNAPSHOT_VERSION ||
+        BinaryIO::Read<int32_t>(input) != _width ||
+        BinaryIO::Read<int32_t>(input) != _height)
+    {
+        fail();
+    }
+    auto cellCount = static_cast<uint32_t>(_width * _height);
+    /** Build everything aside, and only take it if it is consistent */
+    auto tick = BinaryIO::Read<uint32_t>(input);
+    auto score = BinaryIO::Read<int32_t>(input);
+    auto direction = BinaryIO::Read<Direction>(input);
+    auto pendingDirection = BinaryIO::Read<Direction>(input);
+    auto foodIndex = BinaryIO::Read<uint32_t>(input);
+    auto randomState = BinaryIO::Read<Random::State>(input);
+    auto snakeLength = BinaryIO::Read<uint32_t>(input);
+    if (score < 0 || !validDirection(direction) || !validDirection(pendingDirection) ||
+        foodIndex >= cellCount || _level->IsWall(foodIndex) ||
+        snakeLength == 0 || snakeLength >= cellCount - _level->GetWallCount())
+    {
+        fail();
+    }
+    std::vector<Segment> segments(snakeLength);
+    input.read(reinterpret_cast<char*>(segments.data()), sizeof(Segment) * snakeLength);
+    if (!input)
+    {
+        throw std::runtime_error("File is truncated");
+    }
+    Bitboard board{};
+    board.Reset(static_cast<uint32_t>(_width), static_cast<uint32_t>(_height), GetEdges() == Level::Edges::Wrap);
+    board.SetWalls(_level->GetWalls());
+    std::deque<Coordinate> snake{};
+    for (const auto& segment : segments)
+    {
+        auto type = static_cast<CellType>(segment.type);
+        if (segment.index >= cellCount || !board.IsFree(segment.index) || segment.index == foodIndex ||
+            type < CellType::SnakeRight || type > CellType::SnakeDown)
+        {
+            fail();
+        }
+        board.Take(segment.index, static_cast<uint8_t>(SnakeCellDirection(type)));
+        snake.push_back(ToCoordinate(segment.index));
+    }
+    /** The free cells in the order of a new game, without the snake and the food */
+    RandomPool emptyCells{};
+    emptyCells.Reset(cellCount);
+    emptyCells.Fill(_level->GetFreeColumns(), static_cast<uint32_t>(_width), static_cast<uint32_t>(_height));
+    for (const auto& segment : segments)
+    {
+        emptyCells.Remove(segment.index);
+    }
+    emptyCells.Remove(foodIndex);
+    emptyCells.SetRandomState(randomState);
+    _tick = tick;
+    _score = score;
+    _direction = direction;
+    _pendingDirection = pendingDirection;
+    _finished = false;
+    _food = ToCoordinate(foodIndex);
+    _board = std::move(board);
+    _snake = std::move(snake);
+    _emptyCells = std::move(emptyCells);
+}
+
+int GameEngine::GetWidth() const
+{
+    return _width;
+}
+
+int GameEngine::GetHeight() const
+{
+    return _height;
+}
+
+Level::Edges GameEngine::GetEdges() const
+{
+    return _level->GetEdges();
+}
+
+const std::shared_ptr<const CompiledLevel>& GameEngine::GetLevel() const
+{
+    return _level;
+}
+
+GameEngine::CellType GameEngine::GetCell(const Coordinate& coordinate) const
+{
+    return GetCell(ToIndex(coordinate));
+}
+
+GameEngine::CellType GameEngine::GetCell(uint32_t index) const
+{
+    if (!_board.IsFree(index))
+    {
+        return _board.IsWall(index) ?
+            CellType::Wall :
+            SnakeCellType(static_cast<Direction>(_board.GetDirection(index)));
+    }
+    return index == ToIndex(_food) ? CellType::Food : CellType::Empty;
+}
+
+const Bitboard& GameEngine::GetBoard() const
+{
+    return _board;
+}
+
+const std::deque<GameEngine::Coordinate>& GameEngine::GetSnake() const
+{
+    return _snake;
+}
+
+GameEngine::Coordinate GameEngine::GetFood() const
+{
+    return _food;
+}
+
+GameEngine::Direction GameEngine::GetDirection() const
+{
+    return _direction;
+}
+
+int GameEngine::GetScore() const
+{
+    return _score;
+}
+
+uint32_t GameEngine::GetTick() const
+{
+    return _tick;
+}
+
+bool GameEngine::IsFinished() const
+{
+    return _finished;
+}
+
+uint32_t GameEngine::ToIndex(const Coordinate& coordinate) const
+{
+    return static_cast<uint32_t>(coordinate.x + coordinate.y*_width);
+}
+
+GameEngine::Coordinate GameEngine::ToCoordinate(uint32_t index) const
+{
+    return {static_cast<int>(index % _width), static_cast<int>(index / _width)};
+}
+
+GameEngine::Direction GameEngine::OppositeDirection(Direction direction)
+{
+    switch (direction)
+    {
+    case Direction::Up:
+        return Direction::Down;
+    case Direction::Down:
+        return Direction::Up;
+    case Direction::Left:
+        return Direction::Right;
+    case Direction::Right:
+        return Direction::Left;
+    default:
+        throw std::invalid_argument("Invalid direction");
+    }
+}
+
+GameEngine::CellType GameEngine::SnakeCellType(Direction direction)
+{
+    switch (direction)
+    {
+    case Direction::Up:
+        return CellType::SnakeUp;
+    case Direction::Down:
+        return CellType::SnakeDown;
+    case Direction::Left:
+        return CellType::SnakeLeft;
+    case Direction::Right:
+        return CellType::SnakeRight;
+    default:
+        throw std::invalid_argument("Invalid direction");
+    }
+}
+
+void GameEngine::WriteSnake(std::ostream& output) const
+{
+    BinaryIO::Write(output, static_cast<uint32_t>(_snake.size()));
+    /** Written in chunks, one stream call per value is the bulk of the cost */
+    constexpr size_t CHUNK = 256;
+    Segment segments[CHUNK];
+    size_t count = 0;
+    /**
+     * A segment was entered from the one behind it, which saves a look at the board
+     * for all but the tail. On two rows up and down go to the same cell, so the board decides.
+     */
+    auto type = [this](auto segment){
+        auto behind = std::next(segment);
+        if (behind == _snake.end() || _height <= 2)
+        {
+            return GetCell(*segment);
+        }
+        if (segment->x == behind->x)
+        {
+            return segment->y == (behind->y + 1) % _height ? CellType::SnakeDown : CellType::SnakeUp;
+        }
+        return segment->x == (behind->x + 1) % _width ? CellType::SnakeRight : CellType::SnakeLeft;
+    };
+    for (auto segment = _snake.begin(); segment != _snake.end(); segment++)
+    {
+        segments[count++] = {ToIndex(*segment), static_cast<uint8_t>(type(segment))};
+        if (count == CHUNK)
+        {
+            output.write(reinterpret_cast<const char*>(segments), sizeof(Segment) * count);
+            count = 0;
+        }
+    }
+    output.write(reinterpret_cast<const char*>(segments), sizeof(Segment) * count);
+}
+
+GameEngine::Direction GameEngine::SnakeCellDirection(CellType cellType)
+{
+    switch (cellType)
+    {
+    case CellType::SnakeUp:
+        return Direction::Up;
+    case CellType::SnakeDown:
+        return Direction::Down;
+    case CellType::SnakeLeft:
+        return Direction::Left;
+    case CellType::SnakeRight:
+        return Direction::Right;
+    default:
+        throw std::invalid_argument("Invalid snake cell");
+    }
+}
+
+bool GameEngine::Coordinate::operator==(const Coordinate& other) const
+{
+    return x == other.x && y == other.y;
+}
+
+bool GameEngine::Coordinate::operator<(const Coordinate& other) const
+{
+    return x < other.x || (x == other.x && y < other.y);
+}
+
+void GameEngine::RandomPool::Seed(uint64_t seed)
+{
+    _rng.Seed(seed);
+}
+
+void GameEngine::RandomPool::Reset(uint32_t capacity)
+{
+    _pool.clear();
+    _pool.reserve(capacity);
+    _positions.assign(capacity, NOT_IN_POOL);
+}
+
+void GameEngine::RandomPool::Insert(uint32_t value)
+{
+    if (_positions[value] != NOT_IN_POOL)
+    {
+        return;
+    }
+    _positions[value] = static_cast<uint32_t>(_pool.size());
+    _pool.push_back(value);
+}
+
+void GameEngine::RandomPool::Fill(std::span<const uint64_t> columns, uint32_t width, uint32_t height)
+{
+    /** The pool in bit order, x and y follow the bits down the columns so there is no division */
+    _next.assign(width, 0);
+    uint32_t x = 0;
+    uint32_t y = 0;
+    size_t last = 0;
+    for (size_t word = 0; word < columns.size(); word++)
+    {
+        for (auto bits = columns[word]; bits != 0; bits &= bits - 1)
+        {
+            auto bit = word*64 + static_cast<size_t>(std::countr_zero(bits));
+            y += static_cast<uint32_t>(bit - last);
+            last = bit;
+            while (y >= height)
+            {
+                y -= height;
+                _next[++x] = static_cast<uint32_t>(_pool.size());
+            }
+            _pool.push_back(x + y*width);
+        }
+    }
+    while (++x < width)
+    {
+        _next[x] = static_cast<uint32_t>(_pool.size());
+    }
+    /**
+     * Positions are kept row by row, and writing them in pool order would touch a new row,
+     * and a new page, for every cell. So they are written 64 rows at a time across the board,
+     * which keeps those rows in the cache, each column counting up from where it starts in the pool.
+     */
+    for (uint32_t top = 0; top < height; top += 64)
+    {
+        uint32_t rows = std::min(height - top, 64u);
+        for (x = 0; x < width; x++)
+        {
+            auto position = _next[x];
+            auto bits = GetBits(columns, static_cast<size_t>(x) * height + top, rows);
+            for (; bits != 0; bits &= bits - 1)
+            {
+                auto row = static_cast<uint32_t>(std::countr_zero(bits));
+                _positions[x + (top + row)*width] = position++;
+            }
+            _next[x] = position;
+        }
+    }
+}
+
+void GameEngine::RandomPool::Remove(uint32_t value)
+{
+    uint32_t position = _positions[value];
+    if (position == NOT_IN_POOL)
+    {
+        return;
+    }
+    _positions[value] = NOT_IN_POOL;
+    auto tail = _pool.back();
+    _pool.pop_back();
+    if (position == _pool.size())
+    {
+        return;
+    }
+    _pool[position] = tail;
+    _positions[tail] = position;
+}
+
+uint32_t GameEngine::RandomPool::PopRandom()
+{
+    if (_pool.empty())
+    {
+        throw std::out_of_range("Empty pool");
+    }
+    uint32_t value = _pool[_rng.Below(static_cast<uint32_t>(_pool.size()))];
+    Remove(value);
+    return value;
+}
+
+size_t GameEngine::RandomPool::Size() const
+{
+    return _pool.size();
+}
+
+bool GameEngine::RandomPool::Empty() const
+{
+    return _pool.empty();
+}
+
+const std::vector<uint32_t>& GameEngine::RandomPool::Values() const
+{
+    return _pool;
+}
+
+Random::State GameEngine::RandomPool::GetRandomState() const
+{
+    return _rng.GetState();
+}
+
+void GameEngine::RandomPool::SetRandomState(const Random::State& state)
+{
+    _rng.SetState(state);
+}
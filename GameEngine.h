@@ -0,0 +1,277 @@
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+#include <optional>
+#include <istream>
+#include <ostream>
+#include "Bitboard.h"
+#include "CompiledLevel.h"
+#include "Level.h"
+#include "Random.h"
+
+namespace Snake
+{
+    /**
+     * @brief The game rules without the terminal or the event loop.
+     *      This is shared by the interactive game and the headless tools.
+     */
+    class GameEngine
+    {
+    public:
+        struct Coordinate
+        {
+            int x{0};
+            int y{0};
+            bool operator==(const Coordinate& other) const;
+            bool operator<(const Coordinate& other) const;
+        };
+        enum class CellType : uint8_t
+        {
+            Empty,
+            SnakeRight,
+            SnakeLeft,
+            SnakeUp,
+            SnakeDown,
+            Food,
+            Wall,
+        };
+        enum class Direction : uint8_t
+        {
+            Up,
+            Down,
+            Left,
+            Right,
+        };
+        enum class Outcome : uint8_t
+        {
+            /** The snake moved */
+            Moved,
+            /** The snake ate the food */
+            Ate,
+            /** The snake hit something, or went past a solid edge. Nothing is changed. */
+            Dead,
+            /** The snake ate the food and there is no room for new food */
+            Won,
+        };
+        /**
+         * @brief What one step changed, enough to take it back.
+         *      Cells are stored as indices to keep a long history small.
+         */
+        struct TickDelta
+        {
+            static constexpr uint32_t NO_CELL = UINT32_MAX;
+            /** The new head. Past a solid edge, the cell on the other side. */
+            uint32_t head{NO_CELL};
+            /** The freed tail cell, if the snake did not grow */
+            uint32_t tail{NO_CELL};
+            /** The new food, if the old one was eaten. The old food is the head. */
+            uint32_t food{NO_CELL};
+            /** The cell type of the freed tail */
+            CellType tailType{CellType::Empty};
+            /** The direction before the step */
+            Direction direction{Direction::Right};
+            Outcome outcome{Outcome::Moved};
+        };
+        struct StepResult
+        {
+            Outcome outcome{Outcome::Moved};
+            /** The new head */
+            Coordinate head{};
+            /** The freed tail cell, if the snake did not grow */
+            std::optional<Coordinate> tail{};
+            /** The new food, if the old one was eaten */
+            std::optional<Coordinate> food{};
+            TickDelta delta{};
+        };
+
+        /** Keeps cell indices in 24 bits and the board in a few hundred MB */
+        static constexpr int MAX_SIZE = 4096;
+        /** The narrowest board a game is played on */
+        static constexpr int MIN_WIDTH = 10;
+
+        /** An open board that wraps around */
+        GameEngine(int width, int height);
+        /** Compiles the level for this engine alone, see CompiledLevel::Compile */
+        explicit GameEngine(const Level& level);
+        /** A board with the size, edges, walls and spawns of a level, which can be shared */
+        explicit GameEngine(std::shared_ptr<const CompiledLevel> level);
+        ~GameEngine() = default;
+
+        GameEngine(const GameEngine& other) = default;
+        GameEngine& operator=(const GameEngine& other) = default;
+        /** Restoring a game moves the board and the pool in, over a hundred MB on the largest board */
+        GameEngine(GameEngine&& other) noexcept = default;
+        GameEngine& operator=(GameEngine&& other) noexcept = default;
+
+        /**
+         * @brief Start a new game.
+         * 
+         * @param seed Decides where the food shows up, and which spawn the snake starts at.
+         */
+        void Reset(uint64_t seed);
+        /**
+         * @brief Set the direction of the next step.
+         *      Turning back is ignored.
+         * 
+         * @param direction 
+         */
+        void SetDirection(Direction direction);
+        StepResult Step();
+        /**
+         * @brief Take back the last step.
+         *      Food placement after an undo is no longer reproducible from the seed.
+         * 
+         * @param delta The delta of the last step not undone yet.
+         */
+        void Undo(const TickDelta& delta);
+        /**
+         * @brief Take a step again from its delta.
+         *      The food goes where the delta has it and the random state is left alone,
+         *      so a copy of a game can follow the original step by step.
+         * 
+         * @param delta The delta of the step after the current one.
+         */
+        void Redo(const TickDelta& delta);
+        /**
+         * @brief Write the state of an unfinished game in a compact binary form.
+         * 
+         * @param output 
+         */
+        void Serialize(std::ostream& output) const;
+        /**
+         * @brief Restore a state written by Serialize.
+         *      The level is taken from the state, compiled again.
+         *      Nothing changes if it fails.
+         * 
+         * @param input 
+         */
+        void Deserialize(std::istream& input);
+        /**
+         * @brief Write what a game changes in a compact binary form, for checkpoints.
+         *      The level and the empty cells are left out, so it costs O(snake).
+         * 
+         * @param output 
+         */
+        void WriteSnapshot(std::ostream& output) const;
+        /**
+         * @brief Restore a state written by WriteSnapshot on an engine of the same level.
+         *      The empty cells are put back in a new order, so like after an undo
+         *      the food that follows is not the one of the original game.
+         *      Nothing changes if it fails.
+         * 
+         * @param input 
+         */
+        void ReadSnapshot(std::istream& input);
+
+        int GetWidth() const;
+        int GetHeight() const;
+        Level::Edges GetEdges() const;
+        const std::shared_ptr<const CompiledLevel>& GetLevel() const;
+        CellType GetCell(const Coordinate& coordinate) const;
+        CellType GetCell(uint32_t index) const;
+        /** Food is not on it, its cells are free. Walls are taken. */
+        const Bitboard& GetBoard() const;
+        const std::deque<Coordinate>& GetSnake() const;
+        Coordinate GetFood() const;
+        Direction GetDirection() const;
+        int GetScore() const;
+        uint32_t GetTick() const;
+        bool IsFinished() const;
+        uint32_t ToIndex(const Coordinate& coordinate) const;
+        Coordinate ToCoordinate(uint32_t index) const;
+
+        static Direction OppositeDirection(Direction direction);
+        static CellType SnakeCellType(Direction direction);
+
+    private:
+        /**
+         * @brief Cell indices to draw from at random.
+         *      Positions are kept in a dense table instead of a map,
+         *      so every operation is O(1) and costs 8 bytes per cell.
+         */
+        class RandomPool
+        {
+        public:
+            RandomPool() = default;
+            ~RandomPool() = default;
+            RandomPool(const RandomPool& other) = default;
+            RandomPool& operator=(const RandomPool& other) = default;
+            RandomPool(RandomPool&& other) noexcept = default;
+            RandomPool& operator=(RandomPool&& other) noexcept = default;
+            void Seed(uint64_t seed);
+            /**
+             * @brief Empty the pool and accept indices below capacity.
+             * 
+             * @param capacity 
+             */
+            void Reset(uint32_t capacity);
+            void Insert(uint32_t value);
+            /**
+             * @brief Put every set bit of a plane in an empty pool, in bit order,
+             *      a word at a time.
+             *
+             * @param columns Bit y + x*height is cell x + y*width.
+             * @param width
+             * @param height
+             */
+            void Fill(std::span<const uint64_t> columns, uint32_t width, uint32_t height);
+            void Remove(uint32_t value);
+            uint32_t PopRandom();
+            size_t Size() const;
+            bool Empty() const;
+            /** In pool order, which decides what PopRandom returns */
+            const std::vector<uint32_t>& Values() const;
+            Random::State GetRandomState() const;
+            void SetRandomState(const Random::State& state);
+        private:
+            static constexpr uint32_t NOT_IN_POOL = UINT32_MAX;
+
+            Random _rng{};
+            std::vector<uint32_t> _pool{};
+            /** Where each index is in the pool */
+            std::vector<uint32_t> _positions{};
+            /** Per column, the next place in the pool, for Fill */
+            std::vector<uint32_t> _next{};
+        };
+
+        int _width;
+        int _height;
+        std::shared_ptr<const CompiledLevel> _level;
+        /** The walls and the snake, with the direction each segment was entered with */
+        Bitboard _board{};
+        std::deque<Coordinate> _snake{};
+        Coordinate _food{};
+        RandomPool _emptyCells{};
+        Direction _direction{Direction::Right};
+        Direction _pendingDirection{Direction::Right};
+        int _score{0};
+        uint32_t _tick{0};
+        bool _finished{false};
+
+        static constexpr uint32_t STATE_MAGIC = 0x53454E53; /** "SNES" */
+        /**
+         * Version 2 added the edges and the walls, version 1 is read as an open board.
+         * Version 3 added the spawns, earlier ones have the default spawn.
+         */
+        static constexpr uint32_t STATE_VERSION = 3;
+        static constexpr uint32_t SNAPSHOT_MAGIC = 0x50534E53; /** "SNSP" */
+        static constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+        typedef StepResult (GameEngine::*StepFunction)();
+        /** Step for the edges of the board, chosen whenever the level is set */
+        StepFunction _step{nullptr};
+
+        template <typename Edges>
+        StepResult StepOn();
+        static StepFunction SelectStep(Level::Edges edges);
+
+        static Direction SnakeCellDirection(CellType cellType);
+        /** Head first, the cell type of each segment is the direction it was entered with */
+        void WriteSnake(std::ostream& output) const;
+    };
+}
@@ -22,6 +22,14 @@ void GameOverSession::Activate(const GameOverSessionParams& params)
     }
     _active = true;
     _params = params;
+    _dialogShown = false;
+    _console.SetResizeHandler([this](){
+        /** The board is gone with the old layout, only the dialog is kept */
+        if (_dialogShown)
+        {
+            DrawScoreDialog();
+        }
+    });
     PlayAnimation(AnimationState::Start);
 }
 
@@ -37,7 +45,7 @@ void GameOverSession::PlayAnimation(GameOverSession::AnimationState state)
     {
     case AnimationState::Alert1:
     case AnimationState::Alert2:{
-        std::string alertChar = _params.useSimpleGraphics ? "▓▓" : "⚠️";
+        std::string alertChar = _params.halfBlocks ? "▒" : _params.useSimpleGraphics ? "▓▓" : "⚠️";
         _console.PutString(_params.headX, _params.headY, alertChar);
     } break;
     case AnimationState::Snake1:
@@ -53,8 +61,41 @@ void GameOverSession::PlayAnimation(GameOverSession::AnimationState state)
 
 void GameOverSession::ShowScoreDialog()
 {
-    int x = 30;
-    int y = 10;
+    _dialogShown = true;
+    DrawScoreDialog();
+    _console.GetString(DIALOG_X + 10, DIALOG_Y + 3, 9, [this](const std::string_view& name){
+        std::string replay{};
+        if (_params.replay != nullptr)
+        {
+            try
+            {
+                replay = _params.replay->Save();
+            }
+            catch (const std::exception&)
+            {
+                /** The score is still saved, just without a replay to verify it */
+            }
+        }
+        try
+        {
+            LeaderBoard::SaveScore(name, _params.score, replay);
+        }
+        catch (const std::exception&)
+        {
+            if (!replay.empty())
+            {
+                Replay::Remove(replay);
+            }
+            throw;
+        }
+        SwitchBack(0);
+    });
+}
+
+void GameOverSession::DrawScoreDialog()
+{
+    int x = DIALOG_X;
+    int y = DIALOG_Y;
     _console.PutString(x, y++, "┏━━━━━━━━━━━━━━━━━━┓");
     _console.PutString(x, y++, "┃    GAME  OVER    ┃");
     _console.PutString(x, y++, "┃  Score:          ┃");
@@ -62,10 +103,6 @@ void GameOverSession::ShowScoreDialog()
     _console.PutString(x, y++, "┗━━━━━━━━━━━━━━━━━━┛");
     std::string scoreStr = std::to_string(_params.score);
     _console.PutString(x + 10, y - 3, scoreStr);
-    _console.GetString(x + 10, y - 2, 9, [this](const std::string_view& name){
-        LeaderBoard::SaveScore(name, _params.score);
-        SwitchBack(0);
-    });
 }
 
 void GameOverSession::Deactivate()
@@ -76,6 +113,7 @@ void GameOverSession::Deactivate()
     }
     _active = false;
     _console.GetString(0, 0, 0, nullptr);
+    _console.SetResizeHandler(nullptr);
     _animationTimer.Clear();
 }
 
@@ -1,6 +1,8 @@
+#include <memory>
 #include <tev-cpp/Tev.h>
 #include "Session.h"
 #include "Console.h"
+#include "Replay.h"
 
 namespace Snake
 {
@@ -11,6 +13,10 @@ namespace Snake
         int headY{0};
         std::string headChar{""};
         bool useSimpleGraphics{false};
+        /** Saved with the score, so a game without a name leaves no replay behind */
+        std::shared_ptr<const Replay> replay{};
+        /** The board is drawn one column per cell */
+        bool halfBlocks{false};
     };
     class GameOverSession : public Session<GameOverSessionParams, int>
     {
@@ -37,14 +43,19 @@ namespace Snake
             End,
         };
 
+        static constexpr int DIALOG_X = 30;
+        static constexpr int DIALOG_Y = 10;
+
         Tev& _tev;
         Console& _console;
         bool _active{false};
         bool _closed{false};
         GameOverSessionParams _params{};
         Tev::Timeout _animationTimer{};
+        bool _dialogShown{false};
 
         void PlayAnimation(AnimationState state);
         void ShowScoreDialog();
+        void DrawScoreDialog();
     };
 }
\ No newline at end of file
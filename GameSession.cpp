@@ -1,14 +1,23 @@
 #include <stdexcept>
+#include <random>
+#include <algorithm>
+#include <fstream>
 #include "GameSession.h"
 #include "Utility.h"
+#include "BinaryIO.h"
 
 using namespace Snake;
 
+static_assert(Constants::SCORE_UPPER_BOUND >= GameEngine::MAX_SIZE * GameEngine::MAX_SIZE);
+
 GameSession::GameSession(Tev& tev, Console& console)
     : _tev(tev),
       _console(console),
       _score(console, 0, Constants::DISPLAY_HEIGHT - 1),
-      _gameOverSession(tev, console)
+      _gameOverSession(tev, console),
+      _checkpointer(GetSaveFilePath()),
+      _minimap(console),
+      _planner(tev)
 {
 }
 
@@ -25,65 +34,43 @@ void GameSession::Activate(const GameSessionParams& params)
     }
     _active = true;
     _params = params;
+    /** The settings decide who plays, A changes it during the game */
+    _autopilot = _params->autopilot.has_value();
+    _autopilotStrategy = _params->autopilot.value_or(_autopilotStrategy);
     SetupGame(_params->newGame);
 }
 
 void GameSession::SetupGame(bool reset)
 {
-    if (reset || _finished || _cells.empty())
+    if (reset || _engine.IsFinished() || !_started)
     {
-        _finished = false;
-        /** Clear cells */
-        _cells.clear();
-        _emptyCells.Clear();
-        for (int x = 0; x < _width; x++)
-        {
-            for (int y = 0; y < _height; y++)
-            {
-                _cells.push_back(CellType::Empty);
-                _emptyCells.Insert({x, y});
-            }
-        }
-        /** Put the snake starting from the 5th column of the middle row */
-        _snake.clear();
-        for (int i = 0; i < 4; i++)
-        {
-            int x = 5 + i;
-            int y = _height/2;
-            _snake.push_front({x, y});
-            _cells[x + y*_width] = CellType::SnakeRight;
-            _emptyCells.Remove({x, y});
-        }
-        _direction = Direction::Right;
-        _pendingDirection = Direction::Right;
-        /** reset score */
-        _score = 0;
-        /** Generate the initial food */
-        _food = _emptyCells.PopRandom();
-        _cells[_food.x + _food.y*_width] = CellType::Food;
+        _started = true;
+        uint64_t seed = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+        _engine = GameEngine{_params->level};
+        _engine.Reset(seed);
+        _replay = Replay{seed, _params->level->ToLevel()};
+        _practice = _params->practice;
+        _assisted = false;
+        _crashed = false;
+        _history.Reset(0);
+        /** The saved game is replaced by this one */
+        RemoveSavedGame();
+        SetSavedLevel(*_params->level);
     }
-    _console.Clear();
-    /** Draw border */
-    Utility::DrawBox(
-        _console,
-        0, 0,
-        Constants::DISPLAY_WIDTH - 1, Constants::DISPLAY_HEIGHT - 2);
-    /** Draw snake */
-    for (const auto& position : _snake)
+    if (_autopilot)
     {
-        auto cellType = _cells[position.x + position.y*_width];
-        auto location = CellToLocation(position);
-        auto character = CellTypeToChar(cellType, _params->useSimpleGraphics);
-        _console.PutString(location.x, location.y, character);
+        _planner.Reset(_autopilotStrategy, _engine);
+        _assisted = true;
     }
-    /** Draw food */
+    /** The terminal may have been resized while paused */
+    ResetFrame();
+    size_t historySize = _practice ? REWIND_SECONDS * _params->tickRate : 0;
+    if (_history.GetCapacity() != historySize)
     {
-        auto location = CellToLocation(_food);
-        auto character = CellTypeToChar(CellType::Food, _params->useSimpleGraphics);
-        _console.PutString(location.x, location.y, character);
+        _history.Reset(historySize);
     }
-    /** draw status bar */
-    _score.ReDraw();
+    _rewindUntil = {};
+    DrawFrame();
     /** Add input handlers */
     _console.SetKeyHandler(Console::EscapedKeys::Up, [this](){
         DirectionInputHandler(Direction::Up);
@@ -100,10 +87,42 @@ void GameSession::SetupGame(bool reset)
     _console.SetKeyHandler('\x1b', [this](){
         SwitchBack({false});
     });
+    _console.SetResizeHandler([this](){
+        ResetFrame();
+        DrawFrame();
+    });
+    _console.SetKeyHandler('m', [this](){
+        _showMinimap = !_showMinimap;
+        DrawFrame();
+    });
+    _console.SetKeyHandler('M', [this](){
+        _showMinimap = !_showMinimap;
+        DrawFrame();
+    });
+    _console.SetKeyHandler('a', [this](){
+        ToggleAutopilot();
+    });
+    _console.SetKeyHandler('A', [this](){
+        ToggleAutopilot();
+    });
+    if (_practice)
+    {
+        _console.SetKeyHandler('r', [this](){
+            RewindInputHandler();
+        });
+        _console.SetKeyHandler('R', [this](){
+            RewindInputHandler();
+        });
+    }
     /** start frame timer */
+    _tickInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::seconds{1}) / _params->tickRate;
+    auto now = std::chrono::steady_clock::now();
+    _nextTick = now + _tickInterval;
+    _nextRender = now;
     _frameTimerHandle = _tev.SetTimeout(
         std::bind(&GameSession::FrameHandler, this),
-        _params->frameTime);
+        std::chrono::duration_cast<std::chrono::milliseconds>(_tickInterval).count());
 }
 
 void GameSession::Deactivate()
@@ -115,8 +134,16 @@ void GameSession::Deactivate()
     _active = false;
     /** release frame timer */
     _frameTimerHandle.Clear();
+    _planner.Stop();
     /** release input handlers */
     _console.SetKeyHandler('\x1b', nullptr);
+    _console.SetResizeHandler(nullptr);
+    _console.SetKeyHandler('m', nullptr);
+    _console.SetKeyHandler('M', nullptr);
+    _console.SetKeyHandler('r', nullptr);
+    _console.SetKeyHandler('R', nullptr);
+    _console.SetKeyHandler('a', nullptr);
+    _console.SetKeyHandler('A', nullptr);
     _console.SetKeyHandler(Console::EscapedKeys::Up, nullptr);
     _console.SetKeyHandler(Console::EscapedKeys::Down, nullptr);
     _console.SetKeyHandler(Console::EscapedKeys::Left, nullptr);
@@ -133,121 +160,668 @@ void GameSession::Close()
     /** This MUST be set after deactivate */
     _closed = true;
     _gameOverSession.Close();
+    if (_started && !_engine.IsFinished())
+    {
+        try
+        {
+            SaveGame();
+        }
+        catch (const std::exception&)
+        {
+            /** Nothing can be done on the way out */
+        }
+    }
 }
 
-GameSession::Direction GameSession::OppositeDirection(const Direction& direction) const
+bool GameSession::Restore()
 {
-    switch (direction)
+    if (_started || !std::filesystem::exists(GetSaveFilePath()))
     {
-    case Direction::Up:
-        return Direction::Down;
-    case Direction::Down:
-        return Direction::Up;
-    case Direction::Left:
-        return Direction::Right;
-    case Direction::Right:
-        return Direction::Left;
-    default:
-        throw std::invalid_argument("Invalid direction");
+        return false;
+    }
+    try
+    {
+        std::ifstream file(GetSaveFilePath(), std::ios::binary);
+        if (file.fail())
+        {
+            throw std::runtime_error("Failed to open save file for reading");
+        }
+        auto level = CompiledLevel::Compile(Level::Read(file, true));
+        auto flags = BinaryIO::Read<uint8_t>(file);
+        GameEngine engine{level};
+        Replay replay{};
+        if ((flags & (SAVED_PRACTICE | SAVED_ASSISTED)) == 0)
+        {
+            /** Play a ranked game up to where it was, so its replay still holds */
+            replay.seed = BinaryIO::Read<uint64_t>(file);
+            replay.ticks = BinaryIO::Read<uint32_t>(file);
+            replay.ReadTurns(file, BinaryIO::Read<uint32_t>(file));
+            replay.level = level->ToLevel();
+            replay.Play(engine);
+            if (engine.IsFinished() || engine.GetTick() != replay.ticks)
+            {
+                throw std::runtime_error("Invalid saved game");
+            }
+        }
+        else
+        {
+            engine.ReadSnapshot(file);
+        }
+        _engine = std::move(engine);
+        _replay = std::move(replay);
+        _practice = (flags & SAVED_PRACTICE) != 0;
+        _assisted = (flags & SAVED_ASSISTED) != 0;
+        SetSavedLevel(*level);
+    }
+    catch (const std::exception&)
+    {
+        /** A broken save is not worth keeping */
+        RemoveSavedGame();
+        return false;
+    }
+    _started = true;
+    return true;
+}
+
+void GameSession::WriteGame(std::ostream& output) const
+{
+    uint8_t flags = (_practice ? SAVED_PRACTICE : 0) | (_assisted ? SAVED_ASSISTED : 0);
+    BinaryIO::Write(output, flags);
+    if (flags == 0)
+    {
+        /** A ranked game is restored from its replay, which must verify. The turns follow in the log. */
+        BinaryIO::Write(output, _replay.seed);
+        BinaryIO::Write(output, _replay.ticks);
+        BinaryIO::Write(output, static_cast<uint32_t>(_replay.turns.size()));
+    }
+    else
+    {
+        _engine.WriteSnapshot(output);
+    }
+}
+
+void GameSession::WriteTurns(std::ostream& output)
+{
+    _replay.WriteTurns(output, _savedTurns);
+    _savedTurns = _replay.turns.size();
+}
+
+void GameSession::SetSavedLevel(const CompiledLevel& level)
+{
+    /** The level never changes, the checkpoint thread writes it in the form with a list of walls */
+    _checkpointer.SetHeader([level = std::make_shared<const Level>(level.ToLevel())](std::ostream& output){
+        level->Write(output);
+    });
+    _savedTurns = 0;
+}
+
+void GameSession::SaveGame()
+{
+    _checkpointer.Save([this](std::ostream& output){
+        WriteGame(output);
+    }, [this](std::ostream& output){
+        WriteTurns(output);
+    });
+}
+
+void GameSession::RemoveSavedGame()
+{
+    _checkpointer.Remove();
+}
+
+std::filesystem::path GameSession::GetSaveFilePath()
+{
+    return Utility::GetSaveFileRoot() / Constants::SAVE_GAME_FILE;
+}
+
+void GameSession::ResetFrame()
+{
+    /** -2 borders, -3 borders + status bar */
+    int columns = static_cast<int>(_console.GetWidth()) - 2;
+    int lines = static_cast<int>(_console.GetHeight()) - 3;
+    /** A half block cell is one column wide and half a row high */
+    _viewWidth = std::min(_params->halfBlocks ? columns : columns/2, _engine.GetWidth());
+    _viewHeight = std::min(_params->halfBlocks ? lines*2 : lines, _engine.GetHeight());
+    CenterCamera();
+    _renderedCamera = _camera;
+    _minimap.Reset(_engine, CellToLocation({_viewWidth, 0}).x, CellToLocation({0, 0}).y);
+    _dirtyCells.clear();
+    _dirty.assign(_viewWidth * _viewHeight, false);
+    _frame.resize(_viewWidth * _viewHeight);
+    for (int y = 0; y < _viewHeight; y++)
+    {
+        for (int x = 0; x < _viewWidth; x++)
+        {
+            _frame[x + y*_viewWidth] = _engine.GetCell(ToBoard({x, y}));
+        }
     }
 }
 
 void GameSession::FrameHandler()
 {
-    /** Set the next frame handler first */
+    /** 
+     * Run all the ticks that are due, but only draw them at the render rate.
+     * At high tick rates several ticks are shown in one render.
+     */
+    auto now = std::chrono::steady_clock::now();
+    int ticks = 0;
+    while (_nextTick <= now)
+    {
+        _nextTick += _tickInterval;
+        if (now < _rewindUntil)
+        {
+            Rewind();
+        }
+        else if (_crashed)
+        {
+            /** Wait for the player to rewind */
+        }
+        else if (!Tick())
+        {
+            return;
+        }
+        if (++ticks >= MAX_TICKS_PER_FRAME)
+        {
+            _nextTick = now + _tickInterval;
+            break;
+        }
+    }
+    if (_nextRender <= now)
+    {
+        Render();
+        _nextRender = now + std::chrono::seconds{1} / RENDER_RATE;
+    }
+    auto wakeUp = _dirtyCells.empty() ? _nextTick : std::min(_nextTick, _nextRender);
+    auto delay = std::chrono::ceil<std::chrono::milliseconds>(wakeUp - now);
     _frameTimerHandle = _tev.SetTimeout(
         std::bind(&GameSession::FrameHandler, this),
-        _params->frameTime);
-    auto head = _snake.front();
-    auto previousHeadType = (_direction == Direction::Up) ? CellType::SnakeUp :
-        (_direction == Direction::Down) ? CellType::SnakeDown :
-        (_direction == Direction::Left) ? CellType::SnakeLeft :
-        CellType::SnakeRight;
-    _direction = _pendingDirection;
-    auto previousHeadLocation = CellToLocation(head);
-    Coordinate nextHead = head;
-    switch (_direction)
-    {
-    case Direction::Up:
-        nextHead.y = (head.y - 1 + _height) % _height;
-        break;
-    case Direction::Down:
-        nextHead.y = (head.y + 1) % _height;
-        break;
-    case Direction::Left:
-        nextHead.x = (head.x - 1 + _width) % _width;
-        break;
-    case Direction::Right:
-        nextHead.x = (head.x + 1) % _width;
-        break;
-    default:
-        throw std::invalid_argument("Invalid direction");
-    }
-    auto headLocation = CellToLocation(nextHead);
-    auto nextHeadCellType = _cells[nextHead.x + nextHead.y*_width];
-    bool generateFood = false;
-    switch (nextHeadCellType)
-    {
-    case CellType::Empty: {
-        auto tail = _snake.back();
-        _cells[tail.x + tail.y*_width] = CellType::Empty;
-        _emptyCells.Insert(tail);
-        _snake.pop_back();
-        auto emptyChar = CellTypeToChar(CellType::Empty, _params->useSimpleGraphics);
-        auto tailLocation = CellToLocation(tail);
-        _console.PutString(tailLocation.x, tailLocation.y, emptyChar);
-        _emptyCells.Remove(nextHead);
-    } break;
-    case CellType::Food: {
-        ++_score;
-        generateFood = true;
-    } break;
-    default:
-        GameOver({
-            _score.GetScore(),
-            previousHeadLocation.x,
-            previousHeadLocation.y,
-            CellTypeToChar(previousHeadType, _params->useSimpleGraphics),
-            _params->useSimpleGraphics
+        std::max<int64_t>(0, delay.count()));
+}
+
+bool GameSession::Tick()
+{
+    auto previousHead = _engine.GetSnake().front();
+    auto previousHeadType = _engine.GetCell(previousHead);
+    auto previousDirection = _engine.GetDirection();
+    if (_autopilot)
+    {
+        _engine.SetDirection(_planner.Take(_engine));
+    }
+    auto result = _engine.Step();
+    if (result.outcome == GameEngine::Outcome::Dead && _practice && !_autopilot)
+    {
+        /** Stay just before the crash, the player rewinds from there */
+        _engine.Undo(result.delta);
+        _crashed = true;
+        return true;
+    }
+    if (_autopilot)
+    {
+        _planner.Step(_engine, result.delta);
+    }
+    _minimap.Apply(result.delta, false);
+    if (_practice)
+    {
+        _history.Push(result.delta);
+    }
+    else
+    {
+        _replay.Record(_engine, previousDirection);
+    }
+    if (result.outcome == GameEngine::Outcome::Dead)
+    {
+        Render();
+        GameOver(previousHead, previousHeadType);
+        return false;
+    }
+    FollowHead();
+    if (result.tail.has_value())
+    {
+        MarkDirty(result.tail.value());
+    }
+    MarkDirty(result.head);
+    if (result.food.has_value())
+    {
+        MarkDirty(result.food.value());
+    }
+    if (result.outcome == GameEngine::Outcome::Won)
+    {
+        Render();
+        GameOver(previousHead, previousHeadType);
+        return false;
+    }
+    if (_engine.GetTick() % GetCheckpointInterval() == 0)
+    {
+        _checkpointer.Capture([this](std::ostream& output){
+            WriteGame(output);
+        }, [this](std::ostream& output){
+            WriteTurns(output);
         });
+    }
+    return true;
+}
+
+void GameSession::Rewind()
+{
+    auto delta = _history.Pop();
+    if (!delta.has_value())
+    {
+        return;
+    }
+    _engine.Undo(delta.value());
+    _minimap.Apply(delta.value(), true);
+    if (_autopilot)
+    {
+        _planner.Undo(_engine, delta.value());
+    }
+    _crashed = false;
+    FollowHead();
+    MarkDirty(_engine.ToCoordinate(delta->head));
+    if (delta->tail != GameEngine::TickDelta::NO_CELL)
+    {
+        MarkDirty(_engine.ToCoordinate(delta->tail));
+    }
+    if (delta->food != GameEngine::TickDelta::NO_CELL)
+    {
+        MarkDirty(_engine.ToCoordinate(delta->food));
+    }
+}
+
+void GameSession::ToggleAutopilot()
+{
+    if (_autopilot)
+    {
+        _autopilot = false;
+        _planner.Stop();
+        return;
+    }
+    _autopilot = true;
+    _autopilotStrategy = _params->autopilot.value_or(_autopilotStrategy);
+    _planner.Reset(_autopilotStrategy, _engine);
+    _assisted = true;
+    /** A practice crash is left to the autopilot to get out of */
+    _crashed = false;
+}
+
+void GameSession::RewindInputHandler()
+{
+    auto now = std::chrono::steady_clock::now();
+    _rewindUntil = now + (now < _rewindUntil ? REWIND_REPEAT : REWIND_DELAY);
+}
+
+std::string GameSession::GetStatusText() const
+{
+    if (_autopilot)
+    {
+        auto misses = _planner.GetMisses();
+        return "Autopilot: " + std::string{Autopilot::GetName(_autopilotStrategy)} +
+            ", game " + std::to_string(_autopilotGames + 1) +
+            (misses == 0 ? "" : ", " + std::to_string(misses) + " late") + ". A to take over";
+    }
+    if (!_practice)
+    {
+        return "";
+    }
+    if (std::chrono::steady_clock::now() < _rewindUntil)
+    {
+        return "Rewinding...";
+    }
+    if (_crashed)
+    {
+        return "Crashed! Hold R to rewind";
+    }
+    return "Practice: hold R to rewind";
+}
+
+uint32_t GameSession::GetCheckpointInterval() const
+{
+    auto cells = static_cast<uint32_t>(_engine.GetWidth() * _engine.GetHeight());
+    return std::max(Constants::CHECKPOINT_INTERVAL, cells / CHECKPOINT_CELLS_PER_TICK);
+}
+
+void GameSession::MarkDirty(const Coordinate& cell)
+{
+    if (!(_camera == _renderedCamera))
+    {
+        /** The whole view is compared on the next render */
+        return;
+    }
+    auto viewCell = ToView(cell);
+    if (!viewCell.has_value())
+    {
         return;
     }
-    auto headType = (_direction == Direction::Up) ? CellType::SnakeUp :
-        (_direction == Direction::Down) ? CellType::SnakeDown :
-        (_direction == Direction::Left) ? CellType::SnakeLeft :
-        CellType::SnakeRight;
-    _cells[nextHead.x + nextHead.y*_width] = headType;
-    _snake.push_front(nextHead);
-    auto headChar = CellTypeToChar(headType, _params->useSimpleGraphics);
-    _console.PutString(headLocation.x, headLocation.y, headChar);
-    if (generateFood)
-    {
-        if (_emptyCells.Empty())
+    auto index = viewCell->x + viewCell->y*_viewWidth;
+    if (_dirty[index])
+    {
+        return;
+    }
+    _dirty[index] = true;
+    _dirtyCells.push_back(viewCell.value());
+}
+
+void GameSession::Render()
+{
+    _console.BeginFrame();
+    bool scrolled = !(_camera == _renderedCamera) && RenderView();
+    for (const auto& cell : _dirtyCells)
+    {
+        _dirty[cell.x + cell.y*_viewWidth] = false;
+        bool changed = SyncFrame(cell);
+        if (_params->halfBlocks && (cell.y ^ 1) < _viewHeight)
         {
-            GameOver({
-                _score.GetScore(),
-                previousHeadLocation.x,
-                previousHeadLocation.y,
-                CellTypeToChar(previousHeadType, _params->useSimpleGraphics),
-                _params->useSimpleGraphics
-            });
-            return;
+            /** Take the other half along, so the terminal cell is written once */
+            changed = SyncFrame({cell.x, cell.y ^ 1}) || changed;
+        }
+        if (changed)
+        {
+            DrawCell(cell);
+        }
+    }
+    _dirtyCells.clear();
+    if (IsMinimapShown())
+    {
+        /** Scrolling took the minimap along with the board */
+        if (scrolled)
+        {
+            _minimap.Draw();
         }
-        _food = _emptyCells.PopRandom();
-        _cells[_food.x + _food.y*_width] = CellType::Food;
-        auto foodChar = CellTypeToChar(CellType::Food, _params->useSimpleGraphics);
-        auto foodLocation = CellToLocation(_food);
-        _console.PutString(foodLocation.x, foodLocation.y, foodChar);
+        else
+        {
+            _minimap.Render();
+        }
+    }
+    if (_score.GetScore() != _engine.GetScore())
+    {
+        _score = _engine.GetScore();
+    }
+    auto status = GetStatusText();
+    if (status != _status)
+    {
+        /** Pad to wipe out a longer hint */
+        auto length = std::max(status.size(), _status.size());
+        _status = status;
+        status.resize(length, ' ');
+        _console.PutString(STATUS_X, _console.GetHeight() - 1, status);
     }
+    _console.EndFrame();
 }
 
-void GameSession::DirectionInputHandler(const Direction& direction)
+bool GameSession::RenderView()
+{
+    bool scrolled = false;
+    auto boardHeight = _engine.GetHeight();
+    int lines = Wrap(_camera.y - _renderedCamera.y, boardHeight);
+    if (lines > boardHeight/2)
+    {
+        lines -= boardHeight;
+    }
+    int rowsPerLine = _params->halfBlocks ? 2 : 1;
+    if (lines != 0 && lines % rowsPerLine == 0 && std::abs(lines) < _viewHeight)
+    {
+        /** Let the terminal move the rows, only what scrolls in is drawn */
+        auto location = CellToLocation({0, 0});
+        int viewLines = (_viewHeight + rowsPerLine - 1)/rowsPerLine;
+        int scrollLines = lines/rowsPerLine;
+        _console.ScrollRegion(location.y, location.y + viewLines - 1, scrollLines);
+        scrolled = true;
+        if (IsMinimapShown())
+        {
+            /** The board under the minimap is not on the screen, wherever it scrolls to */
+            for (int y = 0; y < _viewHeight; y++)
+            {
+                for (int x = 0; x < _viewWidth; x++)
+                {
+                    if (IsUnderMinimap({x, y}))
+                    {
+                        _frame[x + y*_viewWidth] = UNKNOWN_CELL;
+                    }
+                }
+            }
+        }
+        auto shift = std::abs(lines) * _viewWidth;
+        int firstExposed = 0;
+        if (lines > 0)
+        {
+            std::copy(_frame.begin() + shift, _frame.end(), _frame.begin());
+            std::fill(_frame.end() - shift, _frame.end(), CellType::Empty);
+            firstExposed = viewLines - scrollLines;
+        }
+        else
+        {
+            std::copy_backward(_frame.begin(), _frame.end() - shift, _frame.end());
+            std::fill(_frame.begin(), _frame.begin() + shift, CellType::Empty);
+        }
+        /** The border scrolled along with the rows */
+        auto right = CellToLocation({_viewWidth, 0}).x;
+        for (int row = firstExposed; row < firstExposed + std::abs(scrollLines); row++)
+        {
+            _console.PutString(0, location.y + row, "┃");
+            _console.PutString(right, location.y + row, "┃");
+        }
+    }
+    _renderedCamera = _camera;
+    /** Compare the whole view, Render draws what differs */
+    for (const auto& cell : _dirtyCells)
+    {
+        _dirty[cell.x + cell.y*_viewWidth] = false;
+    }
+    _dirtyCells.clear();
+    for (int y = 0; y < _viewHeight; y++)
+    {
+        for (int x = 0; x < _viewWidth; x++)
+        {
+            if (_frame[x + y*_viewWidth] != _engine.GetCell(ToBoard({x, y})))
+            {
+                _dirty[x + y*_viewWidth] = true;
+                _dirtyCells.push_back({x, y});
+            }
+        }
+    }
+    return scrolled;
+}
+
+bool GameSession::IsMinimapShown() const
+{
+    return _showMinimap && (_viewWidth < _engine.GetWidth() || _viewHeight < _engine.GetHeight());
+}
+
+bool GameSession::IsUnderMinimap(const Coordinate& viewCell) const
+{
+    auto location = CellToLocation(viewCell);
+    return IsMinimapShown() && _minimap.Covers(location.x, _params->halfBlocks ? 1 : 2, location.y);
+}
+
+bool GameSession::SyncFrame(const Coordinate& viewCell)
+{
+    auto& shown = _frame[viewCell.x + viewCell.y*_viewWidth];
+    auto cellType = _engine.GetCell(ToBoard(viewCell));
+    if (shown == cellType)
+    {
+        /** Changed back and forth between two renders */
+        return false;
+    }
+    shown = cellType;
+    return true;
+}
+
+void GameSession::DrawCell(const Coordinate& viewCell)
 {
-    if (_direction == OppositeDirection(direction))
+    if (IsUnderMinimap(viewCell))
+    {
+        return;
+    }
+    auto location = CellToLocation(viewCell);
+    if (!_params->halfBlocks)
     {
+        auto cellType = _frame[viewCell.x + viewCell.y*_viewWidth];
+        _console.PutString(location.x, location.y, CellTypeToChar(cellType, _params->useSimpleGraphics));
         return;
     }
-    _pendingDirection = direction;
+    auto glyph = GetHalfBlockGlyph(viewCell.x, viewCell.y / 2);
+    _console.PutString(location.x, location.y, glyph.text, glyph.foreground, glyph.background);
+}
+
+GameSession::HalfBlockGlyph GameSession::GetHalfBlockGlyph(int x, int line) const
+{
+    auto top = _frame[x + line*2*_viewWidth];
+    auto bottom = line*2 + 1 < _viewHeight ? _frame[x + (line*2 + 1)*_viewWidth] : CellType::Empty;
+    /** SGR background codes are the foreground codes + 10 */
+    auto background = [](CellType cellType){
+        return static_cast<Console::BackgroundColor>(static_cast<int>(CellTypeToColor(cellType)) + 10);
+    };
+    if (top == CellType::Empty && bottom == CellType::Empty)
+    {
+        return {" ", Console::ForegroundColor::Default, Console::BackgroundColor::Default};
+    }
+    if (top == CellType::Empty)
+    {
+        return {"▄", CellTypeToColor(bottom), Console::BackgroundColor::Default};
+    }
+    return {"▀", CellTypeToColor(top), background(bottom)};
+}
+
+Console::ForegroundColor GameSession::CellTypeToColor(CellType cellType)
+{
+    switch (cellType)
+    {
+    case CellType::Empty:
+        return Console::ForegroundColor::Default;
+    case CellType::SnakeRight:
+    case CellType::SnakeLeft:
+    case CellType::SnakeUp:
+    case CellType::SnakeDown:
+        return Console::ForegroundColor::Green;
+    case CellType::Food:
+        return Console::ForegroundColor::Red;
+    case CellType::Wall:
+        return Console::ForegroundColor::BrightBlack;
+    default:
+        throw std::invalid_argument("Invalid cell type");
+    }
+}
+
+void GameSession::CenterCamera()
+{
+    auto head = _engine.GetSnake().front();
+    _camera.x = _viewWidth < _engine.GetWidth() ? Wrap(head.x - _viewWidth/2, _engine.GetWidth()) : 0;
+    _camera.y = _viewHeight < _engine.GetHeight() ? Wrap(head.y - _viewHeight/2, _engine.GetHeight()) : 0;
+}
+
+void GameSession::FollowHead()
+{
+    auto head = _engine.GetSnake().front();
+    _camera.x = FollowAxis(head.x, _camera.x, _viewWidth, _engine.GetWidth(), 1);
+    /** Half blocks scroll by whole terminal rows */
+    _camera.y = FollowAxis(
+        head.y, _camera.y, _viewHeight, _engine.GetHeight(), _params->halfBlocks ? 2 : 1);
+}
+
+int GameSession::FollowAxis(int head, int camera, int view, int size, int step)
+{
+    if (view >= size)
+    {
+        return 0;
+    }
+    int margin = std::min(CAMERA_MARGIN, (view - 1)/2);
+    int offset = Wrap(head - camera, size);
+    int move = 0;
+    if (offset < margin)
+    {
+        move = offset - margin;
+    }
+    else if (offset > view - 1 - margin)
+    {
+        move = offset - (view - 1 - margin);
+    }
+    /** Round away from zero, the head still ends up inside the margin */
+    move = move < 0 ? -((-move + step - 1)/step*step) : (move + step - 1)/step*step;
+    return Wrap(camera + move, size);
+}
+
+int GameSession::Wrap(int value, int size)
+{
+    return (value % size + size) % size;
+}
+
+std::optional<GameSession::Coordinate> GameSession::ToView(const Coordinate& cell) const
+{
+    Coordinate viewCell{
+        Wrap(cell.x - _camera.x, _engine.GetWidth()),
+        Wrap(cell.y - _camera.y, _engine.GetHeight())};
+    if (viewCell.x >= _viewWidth || viewCell.y >= _viewHeight)
+    {
+        return std::nullopt;
+    }
+    return viewCell;
+}
+
+GameSession::Coordinate GameSession::ToBoard(const Coordinate& viewCell) const
+{
+    return {
+        (_camera.x + viewCell.x) % _engine.GetWidth(),
+        (_camera.y + viewCell.y) % _engine.GetHeight()};
+}
+
+void GameSession::DrawFrame()
+{
+    /** One write for the whole screen, no matter how long the snake is */
+    _console.BeginFrame();
+    _console.Clear();
+    /** Draw border */
+    int rowsPerLine = _params->halfBlocks ? 2 : 1;
+    int viewLines = (_viewHeight + rowsPerLine - 1)/rowsPerLine;
+    Utility::DrawBox(
+        _console,
+        0, 0,
+        CellToLocation({_viewWidth, 0}).x, viewLines + 1);
+    /** Draw board */
+    std::string row{};
+    for (int line = 0; line < viewLines; line++)
+    {
+        auto location = CellToLocation({0, line*rowsPerLine});
+        if (_params->halfBlocks)
+        {
+            /** One string per run of the same colors */
+            row.clear();
+            HalfBlockGlyph run{};
+            for (int x = 0; x < _viewWidth; x++)
+            {
+                auto glyph = GetHalfBlockGlyph(x, line);
+                if (x > 0 && (glyph.foreground != run.foreground || glyph.background != run.background))
+                {
+                    _console.PutString(location.x, location.y, row, run.foreground, run.background);
+                    location.x = CellToLocation({x, 0}).x;
+                    row.clear();
+                }
+                run = glyph;
+                row += glyph.text;
+            }
+            _console.PutString(location.x, location.y, row, run.foreground, run.background);
+            continue;
+        }
+        row.clear();
+        for (int x = 0; x < _viewWidth; x++)
+        {
+            row += CellTypeToChar(_frame[x + line*_viewWidth], _params->useSimpleGraphics);
+        }
+        _console.PutString(location.x, location.y, row);
+    }
+    if (IsMinimapShown())
+    {
+        _minimap.Draw();
+    }
+    /** draw status bar */
+    _score.Move(0, _console.GetHeight() - 1);
+    _score = _engine.GetScore();
+    _status = GetStatusText();
+    _console.PutString(STATUS_X, _console.GetHeight() - 1, _status);
+    _console.EndFrame();
+}
+
+void GameSession::DirectionInputHandler(const Direction& direction)
+{
+    _engine.SetDirection(direction);
 }
 
 std::string GameSession::CellTypeToChar(CellType cellType, bool simpleChar) const
@@ -295,90 +869,47 @@ std::string GameSession::CellTypeToChar(CellType cellType, bool simpleChar) cons
     }
 }
 
-void GameSession::GameOver(const GameOverSessionParams& params)
-{
-    _finished = true;
-    SwitchTo(
-        _gameOverSession,
-        params,
-        std::function<void (const int&)>([this](const auto&){
-            SwitchBack({true});
-        }));
-}
-
-GameSession::Coordinate GameSession::CellToLocation(const Coordinate& cell) const
-{
-    return {cell.x*2 + 1, cell.y + 1};
-}
-
-bool GameSession::Coordinate::operator==(const Coordinate& other) const
-{
-    return x == other.x && y == other.y;
-}
-
-bool GameSession::Coordinate::operator<(const Coordinate& other) const
-{
-    return x < other.x || (x == other.x && y < other.y);
-}
-
-template <typename T>
-void GameSession::RandomPool<T>::Insert(const T& value)
+void GameSession::GameOver(const Coordinate& previousHead, CellType previousHeadType)
 {
-    if (_indexMap.find(value) != _indexMap.end())
+    RemoveSavedGame();
+    if (_autopilot)
     {
+        /** Keep playing unattended */
+        _autopilotGames++;
+        SetupGame(true);
         return;
     }
-    _pool.push_back(value);
-    _indexMap[value] = _pool.size() - 1;
-}
-
-template <typename T>
-void GameSession::RandomPool<T>::Remove(const T& value)
-{
-    auto it = _indexMap.find(value);
-    if (it == _indexMap.end())
+    if (_practice || _assisted)
     {
+        /** Practice and autopilot games are not ranked */
+        SwitchBack({true});
         return;
     }
-    size_t index = it->second;
-    _indexMap.erase(it);
-    auto tail = _pool.back();
-    _pool.pop_back();
-    _pool[index] = tail;
-    _indexMap[tail] = index;
+    /** The camera keeps the head in the view */
+    auto previousHeadLocation = CellToLocation(ToView(previousHead).value_or(Coordinate{}));
+    SwitchTo(
+        _gameOverSession,
+        GameOverSessionParams{
+            _score.GetScore(),
+            previousHeadLocation.x,
+            previousHeadLocation.y,
+            _params->halfBlocks ? "█" : CellTypeToChar(previousHeadType, _params->useSimpleGraphics),
+            _params->useSimpleGraphics,
+            std::make_shared<const Replay>(std::move(_replay)),
+            _params->halfBlocks
+        },
+        std::function<void (const int&)>([this](const auto&){
+            SwitchBack({true});
+        }));
 }
 
-template <typename T>
-T GameSession::RandomPool<T>::PopRandom()
+GameSession::Coordinate GameSession::CellToLocation(const Coordinate& viewCell) const
 {
-    if (_pool.empty())
+    if (_params->halfBlocks)
     {
-        throw std::out_of_range("Empty pool");
+        return {viewCell.x + 1, viewCell.y/2 + 1};
     }
-    std::uniform_int_distribution<size_t> dist(0, _pool.size() - 1);
-    size_t index = dist(_rng);
-    T value = _pool[index];
-    Remove(value);
-    return value;
-}
-
-template <typename T>
-size_t GameSession::RandomPool<T>::Size() const
-{
-    return _pool.size();
-}
-
-template <typename T>
-bool GameSession::RandomPool<T>::Empty() const
-{
-    return _pool.empty();
-}
-
-template <typename T>
-void GameSession::RandomPool<T>::Clear()
-{
-    _pool.clear();
-    _indexMap.clear();
+    return {viewCell.x*2 + 1, viewCell.y + 1};
 }
 
 GameSession::ScoreBar::ScoreBar(Console& console, int x, int y)
@@ -407,9 +938,18 @@ int GameSession::ScoreBar::GetScore() const
     return _score;
 }
 
+void GameSession::ScoreBar::Move(int x, int y)
+{
+    _x = x;
+    _y = y;
+}
+
 void GameSession::ScoreBar::ReDraw()
 {
-    std::string scoreStr = std::to_string(_score);
-    scoreStr.append(4 - scoreStr.size(), ' ');
-    _console.PutString(_x, _y, "Score: " + scoreStr);
+    std::string scoreStr = "Score: " + std::to_string(_score);
+    if (scoreStr.size() < static_cast<size_t>(LENGTH))
+    {
+        scoreStr.append(static_cast<size_t>(LENGTH) - scoreStr.size(), ' ');
+    }
+    _console.PutString(_x, _y, scoreStr);
 }
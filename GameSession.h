@@ -1,20 +1,37 @@
 #include <tev-cpp/Tev.h>
-#include <deque>
-#include <map>
 #include <optional>
-#include <random>
+#include <chrono>
+#include <vector>
+#include <filesystem>
 #include "Session.h"
 #include "Console.h"
 #include "Constants.h"
+#include "GameEngine.h"
+#include "CompiledLevel.h"
 #include "GameOverSession.h"
+#include "Replay.h"
+#include "Checkpointer.h"
+#include "TickHistory.h"
+#include "Minimap.h"
+#include "Autopilot.h"
+#include "AutopilotWorker.h"
 
 namespace Snake
 {
     struct GameSessionParams
     {
-        int frameTime{1000};
+        /** Ticks per second */
+        int tickRate{5};
         bool useSimpleGraphics{false};
         bool newGame{true};
+        /** Only applies to a new game, a resumed game keeps its mode */
+        bool practice{false};
+        /** Board of a new game, a resumed game keeps its own */
+        std::shared_ptr<const CompiledLevel> level{CompiledLevel::Compile(Level::Open(39, 22))};
+        /** Two cells per terminal cell, stacked, drawn with colored half blocks */
+        bool halfBlocks{false};
+        /** The strategy that plays the game, nothing to play by hand */
+        std::optional<Autopilot::Strategy> autopilot{};
     };
     struct GameSessionResult
     {
@@ -33,58 +50,46 @@ namespace Snake
 
         void Activate(const GameSessionParams& params) override;
         void Deactivate() override;
+        /**
+         * @note An unfinished game is saved to be restored by the next run.
+         */
         void Close() override;
+        /**
+         * @brief Load the game saved by the last run.
+         * 
+         * @return true if there is a game to resume.
+         */
+        bool Restore();
     
     private:
-        struct Coordinate
+        typedef GameEngine::Coordinate Coordinate;
+        typedef GameEngine::CellType CellType;
+        typedef GameEngine::Direction Direction;
+        struct HalfBlockGlyph
         {
-            int x{0};
-            int y{0};
-            bool operator==(const Coordinate& other) const;
-            bool operator<(const Coordinate& other) const;
-        };
-        enum class CellType
-        {
-            Empty,
-            SnakeRight,
-            SnakeLeft,
-            SnakeUp,
-            SnakeDown,
-            Food,
-            Wall,
-        };
-        enum class Direction
-        {
-            Up,
-            Down,
-            Left,
-            Right,
-        };
-        template <typename T>
-        class RandomPool
-        {
-        public:
-            RandomPool() = default;
-            ~RandomPool() = default;
-            void Insert(const T& value);
-            void Remove(const T& value);
-            T PopRandom();
-            size_t Size() const;
-            bool Empty() const;
-            void Clear();
-        private:
-            std::mt19937 _rng{std::random_device{}()};
-            std::vector<T> _pool{};
-            std::map<T, size_t> _indexMap{};
+            std::string_view text{" "};
+            Console::ForegroundColor foreground{Console::ForegroundColor::Default};
+            Console::BackgroundColor background{Console::BackgroundColor::Default};
         };
         class ScoreBar
         {
         public:
+            /** "Score: " and room for the largest score */
+            static constexpr int LENGTH = [](){
+                int length = 8;
+                for (auto score = Constants::SCORE_UPPER_BOUND; score >= 10; score /= 10)
+                {
+                    length++;
+                }
+                return length;
+            }();
+
             ScoreBar(Console& console, int x, int y);
             ~ScoreBar() = default;
             ScoreBar& operator=(int score);
             ScoreBar& operator++();
             int GetScore() const;
+            void Move(int x, int y);
             void ReDraw();
         private:
             Console& _console;
@@ -93,10 +98,30 @@ namespace Snake
             int _score{0};
         };
 
-        /** -3 borders + status bar */
-        static constexpr int _height{Constants::DISPLAY_HEIGHT - 3};
+        /** The view on the smallest terminal. -3 borders + status bar */
+        static constexpr int MIN_VIEW_HEIGHT{Constants::DISPLAY_HEIGHT - 3};
         /** -2 borders, /2 double width cell */
-        static constexpr int _width{(Constants::DISPLAY_WIDTH - 2)/2};
+        static constexpr int MIN_VIEW_WIDTH{(Constants::DISPLAY_WIDTH - 2)/2};
+        /** The camera moves when the head gets this close to the edge of the view */
+        static constexpr int CAMERA_MARGIN = 6;
+        /** Large boards are checkpointed less often, the state grows with the board */
+        static constexpr uint32_t CHECKPOINT_CELLS_PER_TICK = 1 << 16;
+        /** What a terminal can comfortably display */
+        static constexpr int RENDER_RATE = 60;
+        /** Drop ticks rather than falling further behind */
+        static constexpr int MAX_TICKS_PER_FRAME = 100;
+        /** How far back a practice game can be rewound */
+        static constexpr int REWIND_SECONDS = 10;
+        /** A key press keeps rewinding until the key repeat takes over */
+        static constexpr std::chrono::milliseconds REWIND_DELAY{600};
+        /** Holding the key keeps rewinding as long as it repeats */
+        static constexpr std::chrono::milliseconds REWIND_REPEAT{100};
+        static constexpr int STATUS_X = ScoreBar::LENGTH + 3;
+        /** Never equal to what the engine has, to have a cell drawn again */
+        static constexpr CellType UNKNOWN_CELL = static_cast<CellType>(0xFF);
+        /** Flags of a saved game, a game without any is ranked */
+        static constexpr uint8_t SAVED_PRACTICE = 1 << 0;
+        static constexpr uint8_t SAVED_ASSISTED = 1 << 1;
 
         Tev& _tev;
         Console& _console;
@@ -104,22 +129,119 @@ namespace Snake
         GameOverSession _gameOverSession;
         bool _active{false};
         bool _closed{false};
-        bool _finished{false};
-        std::vector<CellType> _cells{};
-        std::deque<Coordinate> _snake{};
-        Coordinate _food{};
-        RandomPool<Coordinate> _emptyCells{};
-        Direction _direction{Direction::Right};
-        Direction _pendingDirection{Direction::Right};
+        bool _started{false};
+        GameEngine _engine{MIN_VIEW_WIDTH, MIN_VIEW_HEIGHT};
+        Replay _replay{};
         Tev::Timeout _frameTimerHandle{};
         std::optional<GameSessionParams> _params{};
+        Checkpointer _checkpointer;
+        /** Turns of the replay already in the checkpoint log */
+        size_t _savedTurns{0};
+        std::chrono::steady_clock::duration _tickInterval{};
+        std::chrono::steady_clock::time_point _nextTick{};
+        std::chrono::steady_clock::time_point _nextRender{};
+        /** The part of the board on the screen, smaller than the view on small boards */
+        int _viewWidth{MIN_VIEW_WIDTH};
+        int _viewHeight{MIN_VIEW_HEIGHT};
+        /** The board cell in the top left corner of the view */
+        Coordinate _camera{};
+        /** Where the camera was at the last render */
+        Coordinate _renderedCamera{};
+        /** View cells changed since the last render */
+        std::vector<Coordinate> _dirtyCells{};
+        std::vector<bool> _dirty{};
+        /** What is in the view */
+        std::vector<CellType> _frame{};
+        /** Practice games can be rewound and are not ranked */
+        bool _practice{false};
+        /** Practice games stop before a crash until they are rewound */
+        bool _crashed{false};
+        TickHistory _history{};
+        std::chrono::steady_clock::time_point _rewindUntil{};
+        /** The hint on the status bar */
+        std::string _status{};
+        Minimap _minimap;
+        bool _showMinimap{false};
+        /** The autopilot steers the snake while this is set */
+        bool _autopilot{false};
+        Autopilot::Strategy _autopilotStrategy{Autopilot::DEFAULT_STRATEGY};
+        /** Plans the autopilot moves off the event loop */
+        AutopilotWorker _planner;
+        /** Games the autopilot has finished and started again since the session began */
+        uint32_t _autopilotGames{0};
+        /** The autopilot played part of this game, it is not ranked */
+        bool _assisted{false};
 
         void SetupGame(bool reset = true);
-        Direction OppositeDirection(const Direction& direction) const;
         void FrameHandler();
+        /**
+         * @brief Advance the game by one step.
+         * 
+         * @return false if the game is over.
+         */
+        bool Tick();
+        /** Take back one step of a practice game */
+        void Rewind();
+        void RewindInputHandler();
+        void ToggleAutopilot();
+        std::string GetStatusText() const;
+        void MarkDirty(const Coordinate& cell);
+        /** Draw the dirty cells, or the whole view if the camera moved */
+        void Render();
+        /**
+         * @brief Bring the view up to date with the camera.
+         * 
+         * @return true if the terminal rows were scrolled.
+         */
+        bool RenderView();
+        /** Only boards larger than the view have a minimap */
+        bool IsMinimapShown() const;
+        bool IsUnderMinimap(const Coordinate& viewCell) const;
+        /** Put the head in the middle of the view */
+        void CenterCamera();
+        /** Keep the head away from the edges of the view */
+        void FollowHead();
+        /** Camera position on one axis, moved in multiples of step */
+        static int FollowAxis(int head, int camera, int view, int size, int step);
+        static int Wrap(int value, int size);
+        /** The view cell showing a board cell, if it is in the view */
+        std::optional<Coordinate> ToView(const Coordinate& cell) const;
+        Coordinate ToBoard(const Coordinate& viewCell) const;
+        uint32_t GetCheckpointInterval() const;
+        /** Draw the whole screen from the frame snapshot */
+        void DrawFrame();
+        /**
+         * @brief Size the view to the terminal, center it on the head, take the
+         *      frame snapshot from the engine and forget the dirty cells.
+         */
+        void ResetFrame();
+        /**
+         * @brief Write the part of a saved game that changes, after the level.
+         *      A ranked game keeps its replay, any other one an engine snapshot.
+         */
+        void WriteGame(std::ostream& output) const;
+        /** Add the turns taken since the last checkpoint to the checkpoint log */
+        void WriteTurns(std::ostream& output);
+        /** The level saved ahead of every checkpoint, for a new checkpoint log */
+        void SetSavedLevel(const CompiledLevel& level);
+        void SaveGame();
+        void RemoveSavedGame();
+        static std::filesystem::path GetSaveFilePath();
+        /**
+         * @brief Take a view cell from the engine into the frame snapshot.
+         * 
+         * @return true if it changed.
+         */
+        bool SyncFrame(const Coordinate& viewCell);
+        /** Draw the terminal cell showing a view cell from the frame snapshot */
+        void DrawCell(const Coordinate& viewCell);
+        /** The terminal cell showing the two view cells of a line in half block mode */
+        HalfBlockGlyph GetHalfBlockGlyph(int x, int line) const;
+        static Console::ForegroundColor CellTypeToColor(CellType cellType);
         void DirectionInputHandler(const Direction& direction);
         std::string CellTypeToChar(CellType cellType, bool simpleChar) const;
-        Coordinate CellToLocation(const Coordinate& cellCoordinate) const;
-        void GameOver(const GameOverSessionParams& params);
+        /** Screen location of a view cell */
+        Coordinate CellToLocation(const Coordinate& viewCell) const;
+        void GameOver(const Coordinate& previousHead, CellType previousHeadType);
     };
 }
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+#include "GameEngine.h"
+
+namespace Snake
+{
+    /** Edge policy of a level that wraps around */
+    struct WrapEdges
+    {
+        static constexpr bool WRAPS = true;
+    };
+
+    /** Edge policy of a level with solid edges */
+    struct SolidEdges
+    {
+        static constexpr bool WRAPS = false;
+    };
+
+    /**
+     * @brief Moves and cell indices for a board of any size.
+     *      GameEngine steps with it and an edge policy for the level,
+     *      each edge policy is a step of its own, so the edges are not looked at on a step.
+     */
+    class DynamicGeometry
+    {
+    public:
+        typedef GameEngine::Coordinate Coordinate;
+        typedef GameEngine::Direction Direction;
+
+        DynamicGeometry(int width, int height)
+            : _width(width), _height(height)
+        {
+        }
+
+        int GetWidth() const
+        {
+            return _width;
+        }
+
+        int GetHeight() const
+        {
+            return _height;
+        }
+
+        /**
+         * @brief Step to the next cell. A step never goes more than one cell
+         *      past an edge, so there is no division.
+         *
+         * @param cell Moved, around to the other side if it went past an edge.
+         * @return false if it went past an edge that does not wrap.
+         *      Always true with WrapEdges, so the caller's check is compiled out.
+         */
+        template <typename Edges>
+        bool Move(Coordinate& cell, Direction direction) const
+        {
+            bool inside = true;
+            switch (direction)
+            {
+            case Direction::Up:
+                inside = cell.y != 0;
+                cell.y = cell.y == 0 ? _height - 1 : cell.y - 1;
+                break;
+            case Direction::Down:
+                inside = cell.y + 1 != _height;
+                cell.y = cell.y + 1 == _height ? 0 : cell.y + 1;
+                break;
+            case Direction::Left:
+                inside = cell.x != 0;
+                cell.x = cell.x == 0 ? _width - 1 : cell.x - 1;
+                break;
+            case Direction::Right:
+                inside = cell.x + 1 != _width;
+                cell.x = cell.x + 1 == _width ? 0 : cell.x + 1;
+                break;
+            }
+            return Edges::WRAPS || inside;
+        }
+
+        uint32_t ToIndex(const Coordinate& cell) const
+        {
+            return static_cast<uint32_t>(cell.x + cell.y*_width);
+        }
+
+        Coordinate ToCoordinate(uint32_t index) const
+        {
+            auto width = static_cast<uint32_t>(_width);
+            return {static_cast<int>(index % width), static_cast<int>(index / width)};
+        }
+
+    private:
+        int _width;
+        int _height;
+    };
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include "GameEngine.h"
+
+namespace Snake
+{
+    /**
+     * @brief Cell index arithmetic for the searches that walk the board by index.
+     *      On a board with solid edges, the neighbor past an edge is the cell itself,
+     *      which a search has always seen already.
+     */
+    class Grid
+    {
+    public:
+        typedef GameEngine::Direction Direction;
+
+        static constexpr Direction DIRECTIONS[] = {
+            Direction::Up,
+            Direction::Down,
+            Direction::Left,
+            Direction::Right,
+        };
+
+        Grid() = default;
+        Grid(uint32_t width, uint32_t height, bool wraps)
+            : _width(width), _height(height), _size(width * height), _wraps(wraps)
+        {
+        }
+        explicit Grid(const GameEngine& engine)
+            : Grid(
+                static_cast<uint32_t>(engine.GetWidth()),
+                static_cast<uint32_t>(engine.GetHeight()),
+                engine.GetEdges() == Level::Edges::Wrap)
+        {
+        }
+
+        bool operator==(const Grid& other) const = default;
+
+        uint32_t GetWidth() const
+        {
+            return _width;
+        }
+
+        uint32_t GetHeight() const
+        {
+            return _height;
+        }
+
+        uint32_t GetSize() const
+        {
+            return _size;
+        }
+
+        uint32_t Neighbor(uint32_t cell, Direction direction) const
+        {
+            switch (direction)
+            {
+            case Direction::Up:
+                return cell >= _width ? cell - _width : Across(cell, cell + _size - _width);
+            case Direction::Down:
+                return cell + _width < _size ? cell + _width : Across(cell, cell + _width - _size);
+            case Direction::Left:
+                return cell % _width != 0 ? cell - 1 : Across(cell, cell + _width - 1);
+            case Direction::Right:
+                return (cell + 1) % _width != 0 ? cell + 1 : Across(cell, cell + 1 - _width);
+            default:
+                throw std::invalid_argument("Invalid direction");
+            }
+        }
+
+        /** Steps between two cells on an empty board */
+        uint32_t GetDistance(uint32_t from, uint32_t to) const
+        {
+            uint32_t fromY = from / _width;
+            uint32_t toY = to / _width;
+            uint32_t fromX = from - fromY*_width;
+            uint32_t toX = to - toY*_width;
+            uint32_t dx = fromX > toX ? fromX - toX : toX - fromX;
+            uint32_t dy = fromY > toY ? fromY - toY : toY - fromY;
+            if (!_wraps)
+            {
+                return dx + dy;
+            }
+            return std::min(dx, _width - dx) + std::min(dy, _height - dy);
+        }
+
+        std::optional<Direction> ToDirection(uint32_t from, uint32_t to) const
+        {
+            for (auto direction : DIRECTIONS)
+            {
+                if (Neighbor(from, direction) == to)
+                {
+                    return direction;
+                }
+            }
+            return std::nullopt;
+        }
+
+        /** Whether the snake can move into a cell of the game */
+        static bool IsFree(const GameEngine& engine, uint32_t cell)
+        {
+            return engine.GetBoard().IsFree(cell);
+        }
+
+    private:
+        uint32_t _width{0};
+        uint32_t _height{0};
+        uint32_t _size{0};
+        bool _wraps{true};
+
+        uint32_t Across(uint32_t cell, uint32_t wrapped) const
+        {
+            return _wraps ? wrapped : cell;
+        }
+    };
+}
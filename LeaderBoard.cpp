@@ -2,8 +2,13 @@
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <algorithm>
+#include <functional>
+#include <limits>
+#include <set>
+#include <tuple>
 #include "Constants.h"
 #include "Utility.h"
+#include "Replay.h"
 
 using namespace Snake;
 
@@ -26,7 +31,7 @@ bool LeaderBoard::Score::operator>(const Score& other) const
     return name > other.name;
 }
 
-void LeaderBoard::SaveScore(const std::string_view& name, int scoreNum)
+void LeaderBoard::SaveScore(const std::string_view& name, int scoreNum, const std::string_view& replay)
 {
     time_t now = time(nullptr);
     std::string nameStr(name);
@@ -34,22 +39,35 @@ void LeaderBoard::SaveScore(const std::string_view& name, int scoreNum)
     {
         nameStr = "Anonymous";
     }
-    Score score{ nameStr, scoreNum, now };
+    Score score{ nameStr, scoreNum, now, std::string(replay) };
     std::vector<Score> scores = LoadScores();
     scores.push_back(score);
     std::sort(scores.begin(), scores.end(), std::greater<Score>());
     if (scores.size() > Constants::LEADER_BOARD_SIZE)
     {
+        /** Replays of the dropped scores are not needed anymore */
+        for (auto s = scores.begin() + Constants::LEADER_BOARD_SIZE; s != scores.end(); s++)
+        {
+            if (!s->replay.empty())
+            {
+                Replay::Remove(s->replay);
+            }
+        }
         scores.resize(Constants::LEADER_BOARD_SIZE);
     }
     nlohmann::json scoresJson = nlohmann::json::array();
     for (const auto& s : scores)
     {
-        scoresJson.push_back({
+        nlohmann::json item{
             {KEY_NAME, s.name},
             {KEY_SCORE, s.score},
             {KEY_TIMESTAMP, s.timestamp}
-        });
+        };
+        if (!s.replay.empty())
+        {
+            item[KEY_REPLAY] = s.replay;
+        }
+        scoresJson.push_back(item);
     }
     std::ofstream file(GetFilePath());
     if (file.fail())
@@ -67,38 +85,363 @@ std::vector<LeaderBoard::Score> LeaderBoard::LoadScores()
     {
         return {};
     }
-    std::ifstream file(GetFilePath());
+    std::vector<Score> scores{};
+    ReadScores(filePath, [&scores](Score&& score){
+        scores.emplace_back(std::move(score));
+    });
+    std::sort(scores.begin(), scores.end(), std::greater<Score>());
+    return scores;
+}
+
+std::filesystem::file_time_type LeaderBoard::GetLastWriteTime()
+{
+    std::error_code error{};
+    auto time = std::filesystem::last_write_time(GetFilePath(), error);
+    return error ? std::filesystem::file_time_type{} : time;
+}
+
+namespace
+{
+    /** Passes every valid score of a leader board file on while it is parsed */
+    class ScoreParser : public nlohmann::json_sax<nlohmann::json>
+    {
+    public:
+        using AddScoreFunc = std::function<void(LeaderBoard::Score&&)>;
+
+        ScoreParser(
+            const std::string_view& keyName,
+            const std::string_view& keyScore,
+            const std::string_view& keyTimestamp,
+            const std::string_view& keyReplay,
+            const AddScoreFunc& addScore)
+            : _keyName(keyName), _keyScore(keyScore), _keyTimestamp(keyTimestamp), _keyReplay(keyReplay),
+              _addScore(addScore)
+        {
+        }
+
+        bool null() override
+        {
+            return Invalid();
+        }
+
+        bool boolean(bool) override
+        {
+            return Invalid();
+        }
+
+        bool number_integer(number_integer_t value) override
+        {
+            return Number(value);
+        }
+
+        bool number_unsigned(number_unsigned_t value) override
+        {
+            if (value > static_cast<number_unsigned_t>(std::numeric_limits<int64_t>::max()))
+            {
+                return Invalid();
+            }
+            return Number(static_cast<int64_t>(value));
+        }
+
+        bool number_float(number_float_t value, const string_t&) override
+        {
+            /** -2^63 and 2^63 are exact as doubles, a NaN fails both */
+            constexpr auto low = static_cast<number_float_t>(std::numeric_limits<int64_t>::min());
+            if (!(value >= low && value < -low))
+            {
+                return Invalid();
+            }
+            return Number(static_cast<int64_t>(value));
+        }
+
+        bool string(string_t& value) override
+        {
+            if (!InItem())
+            {
+                return true;
+            }
+            if (_key == Key::Name)
+            {
+                _name = std::move(value);
+                _hasName = true;
+            }
+            else if (_key == Key::Replay)
+            {
+                _replay = std::move(value);
+            }
+            else
+            {
+                Invalid();
+            }
+            return true;
+        }
+
+        bool binary(binary_t&) override
+        {
+            return Invalid();
+        }
+
+        bool start_object(size_t) override
+        {
+            Invalid();
+            _depth++;
+            if (_depth == 2 && _inArray)
+            {
+                _inItem = true;
+                _hasName = _hasScore = _hasTimestamp = false;
+                _replay.clear();
+            }
+            _key = Key::Other;
+            return true;
+        }
+
+        bool end_object() override
+        {
+            if (InItem())
+            {
+                if (_hasName && _hasScore && _hasTimestamp)
+                {
+                    AddScore();
+                }
+                _inItem = false;
+            }
+            _depth--;
+            _key = Key::Other;
+            return true;
+        }
+
+        bool key(string_t& value) override
+        {
+            if (_depth != 2)
+            {
+                return true;
+            }
+            _key = value == _keyName ? Key::Name :
+                   value == _keyScore ? Key::Score :
+                   value == _keyTimestamp ? Key::Timestamp :
+                   value == _keyReplay ? Key::Replay :
+                   Key::Other;
+            return true;
+        }
+
+        bool start_array(size_t) override
+        {
+            Invalid();
+            _depth++;
+            if (_depth == 1)
+            {
+                _inArray = true;
+            }
+            return true;
+        }
+
+        bool end_array() override
+        {
+            _depth--;
+            return true;
+        }
+
+        bool parse_error(size_t, const std::string&, const nlohmann::detail::exception&) override
+        {
+            return false;
+        }
+
+        bool IsArray() const
+        {
+            return _inArray;
+        }
+
+    private:
+        enum class Key
+        {
+            Other,
+            Name,
+            Score,
+            Timestamp,
+            Replay,
+        };
+
+        std::string_view _keyName;
+        std::string_view _keyScore;
+        std::string_view _keyTimestamp;
+        std::string_view _keyReplay;
+        const AddScoreFunc& _addScore;
+        int _depth{0};
+        bool _inArray{false};
+        bool _inItem{false};
+        Key _key{Key::Other};
+        std::string _name{};
+        int _score{0};
+        time_t _timestamp{0};
+        /** Optional, a score without a valid replay is still valid */
+        std::string _replay{};
+        bool _hasName{false};
+        bool _hasScore{false};
+        bool _hasTimestamp{false};
+
+        bool InItem() const
+        {
+            return _depth == 2 && _inItem;
+        }
+
+        /** A value of the wrong type invalidates the current key */
+        bool Invalid()
+        {
+            if (!InItem())
+            {
+                return true;
+            }
+            switch (_key)
+            {
+            case Key::Name:
+                _hasName = false;
+                break;
+            case Key::Score:
+                _hasScore = false;
+                break;
+            case Key::Timestamp:
+                _hasTimestamp = false;
+                break;
+            case Key::Replay:
+                _replay.clear();
+                break;
+            default:
+                break;
+            }
+            return true;
+        }
+
+        /** A number that fits in 64 bits, checked against the range of its key */
+        bool Number(int64_t value)
+        {
+            if (!InItem())
+            {
+                return true;
+            }
+            switch (_key)
+            {
+            case Key::Score:
+                /** Ignore invalid scores */
+                _hasScore = value >= 0 && value <= Snake::Constants::SCORE_UPPER_BOUND;
+                _score = _hasScore ? static_cast<int>(value) : 0;
+                break;
+            case Key::Timestamp:
+                _hasTimestamp = value >= std::numeric_limits<time_t>::min() &&
+                    value <= std::numeric_limits<time_t>::max();
+                _timestamp = _hasTimestamp ? static_cast<time_t>(value) : 0;
+                break;
+            default:
+                Invalid();
+                break;
+            }
+            return true;
+        }
+
+        void AddScore()
+        {
+            _addScore({ std::move(_name), _score, _timestamp, std::move(_replay) });
+        }
+    };
+
+    /**
+     * @brief The highest limit distinct scores added so far, in a min heap.
+     *      Scores are the same when their name, score and timestamp are,
+     *      the replay is only a file name and may differ between machines.
+     */
+    class TopScores
+    {
+    public:
+        explicit TopScores(size_t limit)
+            : _limit(limit)
+        {
+            _scores.reserve(limit);
+        }
+
+        void Add(LeaderBoard::Score&& score)
+        {
+            if (_limit == 0)
+            {
+                return;
+            }
+            /** The lowest kept score is at the front */
+            if (_scores.size() == _limit && !(score > _scores.front()))
+            {
+                return;
+            }
+            if (!_keys.emplace(score.name, score.score, score.timestamp).second)
+            {
+                return;
+            }
+            if (_scores.size() == _limit)
+            {
+                std::pop_heap(_scores.begin(), _scores.end(), std::greater<LeaderBoard::Score>());
+                const auto& lowest = _scores.back();
+                _keys.erase({lowest.name, lowest.score, lowest.timestamp});
+                _scores.pop_back();
+            }
+            _scores.emplace_back(std::move(score));
+            std::push_heap(_scores.begin(), _scores.end(), std::greater<LeaderBoard::Score>());
+        }
+
+        /** Sorted from high to low */
+        std::vector<LeaderBoard::Score> Take()
+        {
+            std::sort_heap(_scores.begin(), _scores.end(), std::greater<LeaderBoard::Score>());
+            _keys.clear();
+            return std::move(_scores);
+        }
+
+    private:
+        size_t _limit;
+        std::vector<LeaderBoard::Score> _scores{};
+        std::set<std::tuple<std::string, int, time_t>> _keys{};
+    };
+}
+
+void LeaderBoard::ReadScores(const std::filesystem::path& path, const std::function<void(Score&&)>& addScore)
+{
+    std::ifstream file(path, std::ios::binary);
     if (file.fail())
     {
         throw std::runtime_error("Failed to open leaderboard file for reading");
     }
-    nlohmann::json scoresJson;
-    file >> scoresJson;
-    file.close();
-    if (!scoresJson.is_array())
+    ScoreParser parser{KEY_NAME, KEY_SCORE, KEY_TIMESTAMP, KEY_REPLAY, addScore};
+    bool success = nlohmann::json::sax_parse(file, &parser);
+    if (!success || !parser.IsArray())
     {
         throw std::runtime_error("Invalid leaderboard file format");
     }
-    std::vector<Score> scores;
-    for (const auto& item : scoresJson)
+}
+
+void LeaderBoard::MergeScores(const std::vector<std::filesystem::path>& files, std::ostream& output)
+{
+    /** Nothing beyond the leader board size can make it into the result, one heap for all the files */
+    TopScores top{Constants::LEADER_BOARD_SIZE};
+    for (const auto& file : files)
     {
-        if (!(item.contains(KEY_NAME) && item[KEY_NAME].is_string())
-            || !(item.contains(KEY_SCORE) && item[KEY_SCORE].is_number())
-            || !(item.contains(KEY_TIMESTAMP) && item[KEY_TIMESTAMP].is_number()))
-        {
-            /** Ignore invalid values */
-            continue;
-        }
-        int score = item[KEY_SCORE].get<int>();
-        if (score < 0 || score > Constants::SCORE_UPPER_BOUND)
+        ReadScores(file, [&top](Score&& score){
+            top.Add(std::move(score));
+        });
+    }
+    output << "[";
+    bool first = true;
+    for (const auto& score : top.Take())
+    {
+        nlohmann::json item{
+            {KEY_NAME, score.name},
+            {KEY_SCORE, score.score},
+            {KEY_TIMESTAMP, score.timestamp}
+        };
+        if (!score.replay.empty())
         {
-            /** Ignore invalid scores */
-            continue;
+            item[KEY_REPLAY] = score.replay;
         }
-        scores.emplace_back(item[KEY_NAME].get<std::string>(),
-                            score,
-                            item[KEY_TIMESTAMP].get<time_t>());
+        output << (first ? "\n    " : ",\n    ") << item.dump();
+        first = false;
+    }
+    output << (first ? "]\n" : "\n]\n");
+    if (output.fail())
+    {
+        throw std::runtime_error("Failed to write the merged leaderboard");
     }
-    std::sort(scores.begin(), scores.end(), std::greater<Score>());
-    return scores;
 }
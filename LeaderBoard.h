@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <ostream>
+#include <functional>
 #include <time.h>
 
 namespace Snake
@@ -16,16 +18,38 @@ namespace Snake
             std::string name;
             int score;
             time_t timestamp;
+            /** The replay file name, empty if the score has no replay */
+            std::string replay{};
             bool operator>(const Score& other) const;
+            bool operator==(const Score& other) const = default;
         };
-        static void SaveScore(const std::string_view& name, int score);
+        static void SaveScore(const std::string_view& name, int score, const std::string_view& replay = "");
         static std::vector<Score> LoadScores();
+        /** When the score store was last written, the epoch if there is none yet */
+        static std::filesystem::file_time_type GetLastWriteTime();
+        /**
+         * @brief Merge leader board files into one ranking.
+         *      Entries with the same name, score and timestamp are only kept once.
+         *      At most LEADER_BOARD_SIZE entries are written, and no more are held while reading.
+         * 
+         * @param files 
+         * @param output The merged leader board is written here in the leader board file format.
+         */
+        static void MergeScores(const std::vector<std::filesystem::path>& files, std::ostream& output);
     private:
         static constexpr std::string_view KEY_NAME = "name";
         static constexpr std::string_view KEY_SCORE = "score";
         static constexpr std::string_view KEY_TIMESTAMP = "timestamp";
+        static constexpr std::string_view KEY_REPLAY = "replay";
 
         static std::filesystem::path GetFilePath();
+        /**
+         * @brief Parse a leader board file without building the whole document.
+         * 
+         * @param path 
+         * @param addScore Called with every valid score, in file order.
+         */
+        static void ReadScores(const std::filesystem::path& path, const std::function<void(Score&&)>& addScore);
     };
 }
 
@@ -1,4 +1,7 @@
 #include "LeaderBoardSession.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include "LeaderBoard.h"
 #include "Utility.h"
 #include "Constants.h"
@@ -26,6 +29,37 @@ void LeaderBoardSession::Activate(const int& params)
     _console.SetKeyHandler('\x1b', [this](){
         SwitchBack(0);
     });
+    _console.SetKeyHandler(Console::EscapedKeys::Up, [this](){
+        ScrollBy(-1);
+    });
+    _console.SetKeyHandler(Console::EscapedKeys::Down, [this](){
+        ScrollBy(1);
+    });
+    _console.SetKeyHandler(Console::EscapedKeys::PageUp, [this](){
+        ScrollBy(-static_cast<int>(GetPageSize()));
+    });
+    _console.SetKeyHandler(Console::EscapedKeys::PageDown, [this](){
+        ScrollBy(static_cast<int>(GetPageSize()));
+    });
+    _console.SetKeyHandler(Console::EscapedKeys::Home, [this](){
+        ScrollTo(0);
+    });
+    _console.SetKeyHandler(Console::EscapedKeys::End, [this](){
+        ScrollTo(MaxOffset());
+    });
+    /** Typing filters the names by prefix */
+    for (char c = 0x20; c < 0x7F; c++)
+    {
+        _console.SetKeyHandler(c, [this, c](){
+            PushFilter(c);
+        });
+    }
+    _console.SetKeyHandler('\x7F', [this](){
+        PopFilter();
+    });
+    _console.SetResizeHandler([this](){
+        DrawLeaderBoard();
+    });
     ShowLeaderBoard();
 }
 
@@ -37,6 +71,21 @@ void LeaderBoardSession::Deactivate()
     }
     _active = false;
     _console.SetKeyHandler('\x1b', nullptr);
+    _console.SetKeyHandler(Console::EscapedKeys::Up, nullptr);
+    _console.SetKeyHandler(Console::EscapedKeys::Down, nullptr);
+    _console.SetKeyHandler(Console::EscapedKeys::PageUp, nullptr);
+    _console.SetKeyHandler(Console::EscapedKeys::PageDown, nullptr);
+    _console.SetKeyHandler(Console::EscapedKeys::Home, nullptr);
+    _console.SetKeyHandler(Console::EscapedKeys::End, nullptr);
+    for (char c = 0x20; c < 0x7F; c++)
+    {
+        _console.SetKeyHandler(c, nullptr);
+    }
+    _console.SetKeyHandler('\x7F', nullptr);
+    _console.SetResizeHandler(nullptr);
+    /** The score store is kept for the next visit */
+    _filtered.clear();
+    _rows.clear();
 }
 
 void LeaderBoardSession::Close()
@@ -52,14 +101,36 @@ void LeaderBoardSession::Close()
 
 void LeaderBoardSession::ShowLeaderBoard()
 {
+    /** Load the score store if a game has saved a score since, and show the first page */
+    auto time = LeaderBoard::GetLastWriteTime();
+    if (!_loaded || time != _scoresTime)
+    {
+        _scores = LeaderBoard::LoadScores();
+        _scoresTime = time;
+        _loaded = true;
+    }
+    _filter.clear();
+    _filtered.clear();
+    _filtered.emplace_back(_scores.size());
+    for (size_t i = 0; i < _scores.size(); i++)
+    {
+        _filtered[0][i] = i;
+    }
+    _offset = 0;
+    DrawLeaderBoard();
+}
+
+void LeaderBoardSession::DrawLeaderBoard()
+{
+    _console.BeginFrame();
     _console.Clear();
     size_t y = TOP_MARGIN;
     /** Draw boarder */
     Utility::DrawBox(
         _console,
         0, 0,
-        Constants::DISPLAY_WIDTH - 1,
-        Constants::DISPLAY_HEIGHT - 1);
+        _console.GetWidth() - 1,
+        _console.GetHeight() - 1);
     /** Show the sheet header */
     _console.PutString(SERIAL_OFFSET, y, "#");
     _console.PutString(NAME_OFFSET, y, "Name");
@@ -71,23 +142,177 @@ void LeaderBoardSession::ShowLeaderBoard()
         _console,
         SERIAL_OFFSET, y++,
         END_OFFSET - 1);
-    /** Load and display the leader board */
-    auto scores = LeaderBoard::LoadScores();
-    int i = 1;
-    for (const auto& score : scores)
+    /** A taller page may show the end of the list from an earlier offset */
+    _offset = std::min(_offset, MaxOffset());
+    _rows.assign(GetPageSize(), BlankRow());
+    RenderPage();
+    RenderStatus();
+    _console.EndFrame();
+}
+
+size_t LeaderBoardSession::GetStatusOffset() const
+{
+    return _console.GetHeight() - 2;
+}
+
+size_t LeaderBoardSession::GetPageSize() const
+{
+    return GetStatusOffset() - LIST_OFFSET;
+}
+
+const std::vector<size_t>& LeaderBoardSession::Matches() const
+{
+    return _filtered.back();
+}
+
+size_t LeaderBoardSession::MaxOffset() const
+{
+    auto size = Matches().size();
+    return size > GetPageSize() ? size - GetPageSize() : 0;
+}
+
+void LeaderBoardSession::ScrollBy(int lines)
+{
+    if (lines < 0 && static_cast<size_t>(-lines) > _offset)
+    {
+        ScrollTo(0);
+        return;
+    }
+    ScrollTo(_offset + lines);
+}
+
+void LeaderBoardSession::ScrollTo(size_t offset)
+{
+    offset = std::min(offset, MaxOffset());
+    if (offset == _offset)
     {
-        std::string serial = std::to_string(i++);
-        std::string name = score.name;
-        if (name.size() > NAME_LENGTH)
+        return;
+    }
+    /** Move what is already on the screen instead of redrawing it */
+    int lines = offset > _offset ?
+        static_cast<int>(offset - _offset) :
+        -static_cast<int>(_offset - offset);
+    if (static_cast<size_t>(std::abs(lines)) < GetPageSize())
+    {
+        _console.ScrollRegion(LIST_OFFSET, LIST_OFFSET + GetPageSize() - 1, lines);
+        if (lines > 0)
+        {
+            std::rotate(_rows.begin(), _rows.begin() + lines, _rows.end());
+            std::fill(_rows.end() - lines, _rows.end(), BlankRow());
+        }
+        else
+        {
+            std::rotate(_rows.rbegin(), _rows.rbegin() - lines, _rows.rend());
+            std::fill(_rows.begin(), _rows.begin() - lines, BlankRow());
+        }
+        /** The scrolled region takes the border with it, put it back */
+        size_t first = lines > 0 ? GetPageSize() - lines : 0;
+        size_t last = lines > 0 ? GetPageSize() : -lines;
+        for (size_t row = first; row < last; row++)
+        {
+            _console.PutString(0, LIST_OFFSET + row, "┃");
+            _console.PutString(_console.GetWidth() - 1, LIST_OFFSET + row, "┃");
+        }
+    }
+    _offset = offset;
+    RenderPage();
+    RenderStatus();
+}
+
+void LeaderBoardSession::PushFilter(char c)
+{
+    if (_filter.size() >= FILTER_LENGTH)
+    {
+        return;
+    }
+    _filter.push_back(c);
+    /** Only the previous matches can still match */
+    std::vector<size_t> matches{};
+    size_t position = _filter.size() - 1;
+    char lower = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    for (auto index : Matches())
+    {
+        const auto& name = _scores[index].name;
+        if (name.size() > position &&
+            std::tolower(static_cast<unsigned char>(name[position])) == lower)
+        {
+            matches.push_back(index);
+        }
+    }
+    _filtered.emplace_back(std::move(matches));
+    _offset = 0;
+    RenderPage();
+    RenderStatus();
+}
+
+void LeaderBoardSession::PopFilter()
+{
+    if (_filter.empty())
+    {
+        return;
+    }
+    _filter.pop_back();
+    _filtered.pop_back();
+    _offset = 0;
+    RenderPage();
+    RenderStatus();
+}
+
+std::string LeaderBoardSession::BlankRow()
+{
+    return std::string(END_OFFSET - SERIAL_OFFSET, ' ');
+}
+
+std::string LeaderBoardSession::FormatRow(size_t index) const
+{
+    const auto& score = _scores[index];
+    std::string row = std::to_string(index + 1);
+    row.resize(SERIAL_LENGTH, ' ');
+    std::string name = score.name;
+    name.resize(NAME_LENGTH, ' ');
+    row += name;
+    std::string scoreStr = std::to_string(score.score);
+    scoreStr.resize(SCORE_LENGTH, ' ');
+    row += scoreStr;
+    std::string timeStr = std::ctime(&score.timestamp);
+    /** Drop the trailing new line */
+    while (!timeStr.empty() && timeStr.back() == '\n')
+    {
+        timeStr.pop_back();
+    }
+    timeStr.resize(TIME_LENGTH, ' ');
+    row += timeStr;
+    return row;
+}
+
+void LeaderBoardSession::RenderPage()
+{
+    const auto& matches = Matches();
+    for (size_t row = 0; row < GetPageSize(); row++)
+    {
+        size_t position = _offset + row;
+        std::string text = position < matches.size() ?
+            FormatRow(matches[position]) :
+            BlankRow();
+        if (text == _rows[row])
         {
-            name.resize(NAME_LENGTH);
+            continue;
         }
-        std::string scoreStr = std::to_string(score.score);
-        std::string timeStr = std::ctime(&score.timestamp);
-        _console.PutString(SERIAL_OFFSET, y, serial);
-        _console.PutString(NAME_OFFSET, y, name);
-        _console.PutString(SCORE_OFFSET, y, scoreStr);
-        _console.PutString(TIME_OFFSET, y, timeStr);
-        y++;
+        _console.PutString(SERIAL_OFFSET, LIST_OFFSET + row, text);
+        _rows[row] = std::move(text);
     }
 }
+
+void LeaderBoardSession::RenderStatus()
+{
+    std::string filter = "Filter: " + _filter;
+    filter.resize(NAME_OFFSET - SERIAL_OFFSET + FILTER_LENGTH, ' ');
+    auto size = Matches().size();
+    std::string position = size == 0 ? "0/0" :
+        std::to_string(_offset + 1) + "-" +
+        std::to_string(std::min(_offset + GetPageSize(), size)) + "/" +
+        std::to_string(size);
+    filter += position;
+    filter.resize(END_OFFSET - SERIAL_OFFSET, ' ');
+    _console.PutString(SERIAL_OFFSET, GetStatusOffset(), filter);
+}
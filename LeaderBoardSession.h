@@ -1,7 +1,12 @@
 #pragma once
 
+#include <string>
+#include <vector>
+#include <filesystem>
 #include "Session.h"
 #include "Console.h"
+#include "LeaderBoard.h"
+#include "Constants.h"
 
 namespace Snake
 {
@@ -32,11 +37,44 @@ namespace Snake
         static constexpr size_t TIME_OFFSET = SCORE_OFFSET + SCORE_LENGTH;
         static constexpr size_t END_OFFSET = TIME_OFFSET + TIME_LENGTH;
         static constexpr size_t TOP_MARGIN = 5;
+        /** header + separate line */
+        static constexpr size_t LIST_OFFSET = TOP_MARGIN + 2;
+        static constexpr size_t FILTER_LENGTH = NAME_LENGTH;
 
         Console& _console;
         bool _active{false};
         bool _closed{false};
+        /** The whole score store, only loaded again when the file has changed */
+        std::vector<LeaderBoard::Score> _scores{};
+        std::filesystem::file_time_type _scoresTime{};
+        bool _loaded{false};
+        /**
+         * Indices into _scores matching the filter. One level per filter character,
+         *      so extending the filter only scans the previous matches 
+         *      and removing a character is free.
+         */
+        std::vector<std::vector<size_t>> _filtered{};
+        std::string _filter{};
+        /** Index into the current filtered list of the first visible row */
+        size_t _offset{0};
+        /** What is currently on the screen, one entry per visible row */
+        std::vector<std::string> _rows{};
 
         void ShowLeaderBoard();
+        /** Draw the screen for the current terminal size */
+        void DrawLeaderBoard();
+        /** Leave the last line inside the border for the status bar */
+        size_t GetStatusOffset() const;
+        size_t GetPageSize() const;
+        const std::vector<size_t>& Matches() const;
+        size_t MaxOffset() const;
+        void ScrollTo(size_t offset);
+        void ScrollBy(int lines);
+        void PushFilter(char c);
+        void PopFilter();
+        static std::string BlankRow();
+        std::string FormatRow(size_t index) const;
+        void RenderPage();
+        void RenderStatus();
     };
 }
@@ -0,0 +1,476 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "Level.h"
+#include "BinaryIO.h"
+#include "GameEngine.h"
+
+using namespace Snake;
+
+namespace
+{
+    constexpr std::string_view EDGES = "edges ";
+    constexpr std::string_view WRAP = "wrap";
+    constexpr std::string_view SOLID = "solid";
+    constexpr char WALL = '#';
+    constexpr char FREE = '.';
+    /** By GameEngine::Direction */
+    constexpr char SPAWNS[] = {'^', 'v', '<', '>'};
+
+    /** map_1 to map_10 of originalCode/snake.cpp, its transparent blocks are walls too */
+    constexpr const char* BUILT_IN[Level::BUILT_IN_COUNT] = {
+        R"(
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+)",
+        R"(
+##############################
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+##############################
+)",
+        R"(
+##########..........##########
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+..............................
+..............................
+..............................
+..............................
+..............................
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+##########..........##########
+)",
+        R"(
+..............................
+..............................
+..............................
+..............................
+....#####............#####....
+....#####............#####....
+....#####............#####....
+....#####............#####....
+....#####............#####....
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+....#####............#####....
+....#####............#####....
+....#####............#####....
+....#####............#####....
+....#####............#####....
+..............................
+..............................
+..............................
+..............................
+)",
+        R"(
+...########################...
+.###......................###.
+.###......................###.
+####......................####
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+#............................#
+####......................####
+.###......................###.
+.###......................###.
+...########################...
+)",
+        R"(
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+##########..........##########
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+##########..........##########
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+)",
+        R"(
+....................#.........
+....................#.........
+....................#.........
+....................#.........
+....................#.........
+....................#.........
+....................#.........
+##########..........#.........
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+..............................
+.........#..........##########
+.........#....................
+.........#....................
+.........#....................
+.........#....................
+.........#....................
+.........#....................
+.........#....................
+)",
+        R"(
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+..............##..............
+)",
+        R"(
+..............................
+..............................
+..............................
+...#####....#####.....#####...
+.......#........#.........#...
+.......#........#.........#...
+...#####.....####......####...
+...#............#.........#...
+...#............#.........#...
+...#####....#####.....#####...
+..............................
+..............................
+..............................
+..............................
+..............................
+...#####....#####.....#####...
+.......#........#.........#...
+.......#........#.........#...
+...#####.....####......####...
+...#............#.........#...
+...#............#.........#...
+...#####....#####.....#####...
+..............................
+..............................
+..............................
+)",
+        R"(
+..............................
+..............................
+..............................
+...#.......#........######....
+...#...#...#........######....
+...#...#...#........######....
+...#...#...#........######....
+...#...#...#........######....
+...#...#...#........######....
+...#########........######....
+..............................
+..............................
+..............................
+..............................
+..............................
+....#...............#####.....
+....#...............#.........
+....#...............#.........
+....#...............####......
+....#...............#.........
+....#...............#.........
+....#####...........#.........
+..............................
+..............................
+..............................
+)",
+    };
+}
+
+Level Level::Open(int width, int height)
+{
+    return Level{"", width, height, Edges::Wrap, {}, {GetDefaultSpawn(width, height)}};
+}
+
+Level Level::BuiltIn(int number)
+{
+    if (number < 1 || number > BUILT_IN_COUNT)
+    {
+        throw std::invalid_argument("Invalid level number");
+    }
+    std::istringstream input{BUILT_IN[number - 1]};
+    return Parse(input, std::to_string(number));
+}
+
+Level Level::Parse(std::istream& input, const std::string_view& name)
+{
+    Level level{};
+    level.name = name;
+    std::string line{};
+    while (std::getline(input, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.empty() || line.front() == ';')
+        {
+            continue;
+        }
+        if (line.starts_with(EDGES))
+        {
+            auto edges = std::string_view{line}.substr(EDGES.size());
+            if (level.height != 0 || (edges != WRAP && edges != SOLID))
+            {
+                throw std::runtime_error("Invalid level edges");
+            }
+            level.edges = edges == SOLID ? Edges::Solid : Edges::Wrap;
+            continue;
+        }
+        if (level.height == 0)
+        {
+            level.width = static_cast<int>(line.size());
+        }
+        else if (line.size() != static_cast<size_t>(level.width))
+        {
+            throw std::runtime_error("Level rows differ in length");
+        }
+        uint32_t start = static_cast<uint32_t>(level.height) * static_cast<uint32_t>(level.width);
+        for (size_t x = 0; x < line.size(); x++)
+        {
+            auto cell = start + static_cast<uint32_t>(x);
+            auto spawn = std::find(std::begin(SPAWNS), std::end(SPAWNS), line[x]);
+            if (line[x] == WALL)
+            {
+                level.walls.push_back(cell);
+            }
+            else if (spawn != std::end(SPAWNS))
+            {
+                level.spawns.push_back({cell, static_cast<uint8_t>(spawn - std::begin(SPAWNS))});
+            }
+            else if (line[x] != FREE)
+            {
+                throw std::runtime_error("Invalid level cell");
+            }
+        }
+        level.height++;
+    }
+    if (input.bad())
+    {
+        throw std::runtime_error("Failed to read level");
+    }
+    if (level.height == 0)
+    {
+        throw std::runtime_error("Level has no rows");
+    }
+    if (level.spawns.empty())
+    {
+        level.spawns.push_back(GetDefaultSpawn(level.width, level.height));
+    }
+    return level;
+}
+
+Level Level::Load(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (file.fail())
+    {
+        throw std::runtime_error("Failed to open level file");
+    }
+    return Parse(file, path.stem().string());
+}
+
+Level::Spawn Level::GetDefaultSpawn(int width, int height)
+{
+    return {static_cast<uint32_t>(8 + height/2*width), static_cast<uint8_t>(GameEngine::Direction::Right)};
+}
+
+void Level::Write(std::ostream& output) const
+{
+    BinaryIO::Write(output, static_cast<uint32_t>(name.size()));
+    output.write(name.data(), static_cast<std::streamsize>(name.size()));
+    BinaryIO::Write(output, static_cast<int32_t>(width));
+    BinaryIO::Write(output, static_cast<int32_t>(height));
+    BinaryIO::Write(output, edges);
+    BinaryIO::Write(output, static_cast<uint32_t>(walls.size()));
+    output.write(reinterpret_cast<const char*>(walls.data()),
+        static_cast<std::streamsize>(sizeof(uint32_t) * walls.size()));
+    BinaryIO::Write(output, static_cast<uint32_t>(spawns.size()));
+    for (const auto& spawn : spawns)
+    {
+        BinaryIO::Write(output, spawn.head);
+        BinaryIO::Write(output, spawn.direction);
+    }
+}
+
+Level Level::Read(std::istream& input, bool hasSpawns)
+{
+    auto fail = [](){
+        throw std::runtime_error("Invalid level");
+    };
+    /** Names come from file names */
+    constexpr uint32_t MAX_NAME = 255;
+    Level level{};
+    auto nameSize = BinaryIO::Read<uint32_t>(input);
+    if (nameSize > MAX_NAME)
+    {
+        fail();
+    }
+    level.name.resize(nameSize);
+    input.read(level.name.data(), nameSize);
+    level.width = BinaryIO::Read<int32_t>(input);
+    level.height = BinaryIO::Read<int32_t>(input);
+    level.edges = BinaryIO::Read<Edges>(input);
+    if (level.width < 1 || level.height < 1 ||
+        level.width > GameEngine::MAX_SIZE || level.height > GameEngine::MAX_SIZE ||
+        static_cast<uint8_t>(level.edges) > static_cast<uint8_t>(Edges::Solid))
+    {
+        fail();
+    }
+    auto cellCount = static_cast<uint32_t>(level.width * level.height);
+    auto wallCount = BinaryIO::Read<uint32_t>(input);
+    if (wallCount >= cellCount)
+    {
+        fail();
+    }
+    level.walls.resize(wallCount);
+    input.read(reinterpret_cast<char*>(level.walls.data()), sizeof(uint32_t) * wallCount);
+    if (!input)
+    {
+        throw std::runtime_error("File is truncated");
+    }
+    for (size_t i = 0; i < level.walls.size(); i++)
+    {
+        if (level.walls[i] >= cellCount || (i > 0 && level.walls[i] <= level.walls[i - 1]))
+        {
+            fail();
+        }
+    }
+    if (!hasSpawns)
+    {
+        level.spawns.push_back(GetDefaultSpawn(level.width, level.height));
+        return level;
+    }
+    auto spawnCount = BinaryIO::Read<uint32_t>(input);
+    if (spawnCount == 0 || spawnCount > cellCount)
+    {
+        fail();
+    }
+    level.spawns.resize(spawnCount);
+    for (auto& spawn : level.spawns)
+    {
+        spawn.head = BinaryIO::Read<uint32_t>(input);
+        spawn.direction = BinaryIO::Read<uint8_t>(input);
+        if (spawn.head >= cellCount || spawn.direction > static_cast<uint8_t>(GameEngine::Direction::Right))
+        {
+            fail();
+        }
+    }
+    return level;
+}
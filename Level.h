@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+#include <istream>
+#include <ostream>
+
+namespace Snake
+{
+    /**
+     * @brief A board to play on: its size, what happens at the edges, the walls on it
+     *      and where the snake starts.
+     *      Levels are written as text, one line per row, '#' for a wall and '.' for a free cell.
+     *      '^', 'v', '<' or '>' is a free cell where the snake can start, heading that way.
+     *      A line "edges solid" before the rows makes the edges deadly, they wrap around otherwise.
+     *      Lines starting with ';' are comments.
+     *      CompiledLevel is the form the engine plays.
+     */
+    struct Level
+    {
+        enum class Edges : uint8_t
+        {
+            /** A step past an edge comes back on the other side */
+            Wrap,
+            /** A step past an edge is a crash */
+            Solid,
+        };
+
+        /** Where a snake starts, its body trails behind the head */
+        struct Spawn
+        {
+            /** x + y*width */
+            uint32_t head{0};
+            /** A GameEngine::Direction */
+            uint8_t direction{0};
+            bool operator==(const Spawn& other) const = default;
+        };
+
+        /** The maps of the original game, numbered from 1 */
+        static constexpr int BUILT_IN_COUNT = 10;
+        /** Of the snake a game starts with */
+        static constexpr int SPAWN_LENGTH = 4;
+
+        std::string name{};
+        int width{0};
+        int height{0};
+        Edges edges{Edges::Wrap};
+        /** Cells as x + y*width, in increasing order */
+        std::vector<uint32_t> walls{};
+        /** At least one, the seed of a game picks one */
+        std::vector<Spawn> spawns{};
+
+        /** No walls, wrapping around */
+        static Level Open(int width, int height);
+        /**
+         * @brief A map of the original game, 30 x 25 and wrapping around.
+         *
+         * @param number From 1 to BUILT_IN_COUNT.
+         */
+        static Level BuiltIn(int number);
+        /**
+         * @brief Read a level from its text form.
+         *      The size and the spawns are checked by CompiledLevel, not here.
+         *      Without a spawn in the text the snake starts at GetDefaultSpawn.
+         *
+         * @param input
+         * @param name Given to the level.
+         */
+        static Level Parse(std::istream& input, const std::string_view& name);
+        /** Parse a file, named after the file without its extension */
+        static Level Load(const std::filesystem::path& path);
+        /** Heading right from the 9th column of the middle row, as the original game */
+        static Spawn GetDefaultSpawn(int width, int height);
+        /** The compact form saved with replays */
+        void Write(std::ostream& output) const;
+        /**
+         * @brief Read the compact form.
+         *
+         * @param input
+         * @param hasSpawns Replays before version 3 have none, the default spawn is used.
+         */
+        static Level Read(std::istream& input, bool hasSpawns);
+        bool operator==(const Level& other) const = default;
+    };
+}
@@ -4,14 +4,17 @@
 
 using namespace Snake;
 
-MainSession::MainSession(Tev& tev, Console& console)
+MainSession::MainSession(Tev& tev, Console& console, SettingsService& settings)
     : _tev(tev),
       _console(console),
       _mainMenu(console, 30, 15),
       _gameSession(tev, console),
       _leaderBoardSession(console),
-      _settingsSession(console)
+      _settingsSession(console, settings),
+      _settings(settings)
 {
+    /** Continue where the last run stopped */
+    _resume = _gameSession.Restore();
 }
 
 MainSession::~MainSession()
@@ -27,37 +30,23 @@ void MainSession::Activate(const int& params)
         return;
     }
     _active = true;
-    /** Load settings */
-    _settings = Settings::Load();
-    _console.Clear();
-    /** Show banner */
-    /** There is an additional \n at the start */
-    constexpr std::string_view banner = R"(
-                 _______..__   __.      ___       __  ___  _______ 
-                /       ||  \ |  |     /   \     |  |/  / |   ____|
-               |   (----`|   \|  |    /  ^  \    |  '  /  |  |__   
-                \   \    |  . `  |   /  /_\  \   |    <   |   __|  
-            .----)   |   |  |\   |  /  _____  \  |  .  \  |  |____ 
-            |_______/    |__| \__| /__/     \__\ |__|\__\ |_______|)";
-    _console.PutString(0,5,banner);
-    /** Draw boarder */
-    Utility::DrawBox(
-        _console,
-        0, 0,
-        Constants::DISPLAY_WIDTH - 1,
-        Constants::DISPLAY_HEIGHT - 1);
+    /** The screen is replaced in one frame */
+    _console.BeginFrame();
+    DrawScreen();
     /** Activate options */
     std::string startGameTitle = _resume ? 
         "[    Resume game   ]" : 
         "[    Start game    ]";
     _mainMenu.AddOption(startGameTitle, [this](){
-        int frameTime = _settings.gameSpeed == Settings::GameSpeed::Slow ? 300 :
-                       _settings.gameSpeed == Settings::GameSpeed::Normal ? 200 :
-                       _settings.gameSpeed == Settings::GameSpeed::Fast ? 133 : 88;
+        const auto& settings = _settings.Get();
         GameSessionParams params{
-            frameTime,
-            _settings.useSimpleGraphics,
-            !_resume
+            settings.GetEffectiveTickRate(),
+            settings.useSimpleGraphics,
+            !_resume,
+            settings.practiceMode,
+            _settings.GetLevel(),
+            settings.useHalfBlocks,
+            Autopilot::ParseKey(settings.autopilot)
         };
         SwitchTo(_gameSession, params, std::function<void(const GameSessionResult&)>(
             [this](const auto& result){
@@ -68,8 +57,7 @@ void MainSession::Activate(const int& params)
     });
     _mainMenu.AddOption("[     Settings     ]", [this](){
         SwitchTo(_settingsSession, 0, std::function<void(const Settings&)>(
-            [this](const auto& settings){
-                _settings = settings;
+            [this](const auto&){
                 Activate(0);
             }
         ));
@@ -97,6 +85,32 @@ void MainSession::Activate(const int& params)
         _mainMenu.Confirm();
     });
     _mainMenu.Bootstrap();
+    _console.EndFrame();
+    _console.SetResizeHandler([this](){
+        DrawScreen();
+        _mainMenu.ReDraw();
+    });
+}
+
+void MainSession::DrawScreen()
+{
+    _console.Clear();
+    /** Show banner */
+    /** There is an additional \n at the start */
+    constexpr std::string_view banner = R"(
+                 _______..__   __.      ___       __  ___  _______ 
+                /       ||  \ |  |     /   \     |  |/  / |   ____|
+               |   (----`|   \|  |    /  ^  \    |  '  /  |  |__   
+                \   \    |  . `  |   /  /_\  \   |    <   |   __|  
+            .----)   |   |  |\   |  /  _____  \  |  .  \  |  |____ 
+            |_______/    |__| \__| /__/     \__\ |__|\__\ |_______|)";
+    _console.PutString(0,5,banner);
+    /** Draw boarder */
+    Utility::DrawBox(
+        _console,
+        0, 0,
+        _console.GetWidth() - 1,
+        _console.GetHeight() - 1);
 }
 
 void MainSession::Deactivate()
@@ -110,6 +124,7 @@ void MainSession::Deactivate()
     _console.SetKeyHandler(Console::EscapedKeys::Down, nullptr);
     _console.SetKeyHandler('\n', nullptr);
     _console.SetKeyHandler(' ', nullptr);
+    _console.SetResizeHandler(nullptr);
     _mainMenu.Clear();
 }
 
@@ -148,6 +163,18 @@ void MainSession::MainMenu::Option::Deselect()
     _console.PutString(_x, _y, _text);
 }
 
+void MainSession::MainMenu::Option::ReDraw()
+{
+    if (_selected)
+    {
+        Select();
+    }
+    else
+    {
+        Deselect();
+    }
+}
+
 std::function<void()> MainSession::MainMenu::Option::GetAction() const
 {
     return _action;
@@ -234,6 +261,14 @@ void MainSession::MainMenu::Confirm()
     action();
 }
 
+void MainSession::MainMenu::ReDraw()
+{
+    for (auto& option : _options)
+    {
+        option.ReDraw();
+    }
+}
+
 void MainSession::MainMenu::Clear()
 {
     _selectedOption.Clear();
@@ -5,14 +5,14 @@
 #include "GameSession.h"
 #include "LeaderBoardSession.h"
 #include "SettingsSession.h"
-#include "Settings.h"
+#include "SettingsService.h"
 
 namespace Snake
 {
     class MainSession : public Session<int, int>
     {
     public:
-        MainSession(Tev& tev, Console& console);
+        MainSession(Tev& tev, Console& console, SettingsService& settings);
         ~MainSession() override;
 
         MainSession(const MainSession& other) = delete;
@@ -25,6 +25,9 @@ namespace Snake
         void Deactivate() override;
         void Close() override;
     private:
+        /** Everything but the menu */
+        void DrawScreen();
+
         class MainMenu
         {
         public:
@@ -37,6 +40,7 @@ namespace Snake
                     const std::function<void()>& action);
                 void Select();
                 void Deselect();
+                void ReDraw();
                 std::function<void()> GetAction() const;
             private:
                 Console& _console;
@@ -53,6 +57,8 @@ namespace Snake
             void SelectNext();
             void SelectPrevious();
             void Confirm();
+            /** Draw all options again, keeping the selection */
+            void ReDraw();
             void Clear();
         private:
             class SelectedOption
@@ -78,7 +84,7 @@ namespace Snake
         GameSession _gameSession;
         LeaderBoardSession _leaderBoardSession;
         SettingsSession _settingsSession;
-        Settings _settings{};
+        SettingsService& _settings;
         bool _active{false};
         bool _closed{false};
         bool _resume{false};
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include "Minimap.h"
+
+using namespace Snake;
+
+namespace
+{
+    /** Braille dot bits by position in the character, [y][x] */
+    constexpr uint8_t DOT_BITS[4][2] = {
+        {0x01, 0x08},
+        {0x02, 0x10},
+        {0x04, 0x20},
+        {0x40, 0x80},
+    };
+}
+
+Minimap::Minimap(Console& console)
+    : _console(console)
+{
+}
+
+void Minimap::Reset(const GameEngine& engine, int right, int top)
+{
+    _boardWidth = engine.GetWidth();
+    int boardHeight = engine.GetHeight();
+    /** Round up, so the whole board fits */
+    _blockWidth = (_boardWidth + MAX_COLUMNS*2 - 1) / (MAX_COLUMNS*2);
+    _blockHeight = (boardHeight + MAX_ROWS*4 - 1) / (MAX_ROWS*4);
+    int dotColumns = (_boardWidth + _blockWidth - 1) / _blockWidth;
+    int dotRows = (boardHeight + _blockHeight - 1) / _blockHeight;
+    _columns = (dotColumns + 1) / 2;
+    _rows = (dotRows + 3) / 4;
+    _x = right - _columns;
+    _y = top;
+    _counts.assign(_columns*2 * _rows*4, 0);
+    _dots.assign(_columns * _rows, 0);
+    _dirty.assign(_columns * _rows, false);
+    _dirtyCharacters.clear();
+    /** Walls never change, they are counted once */
+    engine.GetLevel()->ForEachWall([this](uint32_t wall){
+        Add(wall, 1);
+    });
+    for (const auto& segment : engine.GetSnake())
+    {
+        Add(engine.ToIndex(segment), 1);
+    }
+    auto food = engine.ToIndex(engine.GetFood());
+    Add(food, 1);
+    _foodCharacter = GetCharacter(food);
+}
+
+void Minimap::Apply(const GameEngine::TickDelta& delta, bool undo)
+{
+    typedef GameEngine::TickDelta TickDelta;
+    int sign = undo ? -1 : 1;
+    switch (delta.outcome)
+    {
+    case GameEngine::Outcome::Moved:
+        Add(delta.head, sign);
+        Add(delta.tail, -sign);
+        break;
+    case GameEngine::Outcome::Ate:
+    case GameEngine::Outcome::Won:
+        /** The head takes the place of the food, only the new food is added */
+        if (delta.food != TickDelta::NO_CELL)
+        {
+            Add(delta.food, sign);
+        }
+        SetFood(undo || delta.food == TickDelta::NO_CELL ? delta.head : delta.food);
+        break;
+    default:
+        break;
+    }
+}
+
+void Minimap::Render()
+{
+    for (auto character : _dirtyCharacters)
+    {
+        _dirty[character] = false;
+        DrawCharacter(character);
+    }
+    _dirtyCharacters.clear();
+}
+
+void Minimap::Draw()
+{
+    for (auto character : _dirtyCharacters)
+    {
+        _dirty[character] = false;
+    }
+    _dirtyCharacters.clear();
+    for (size_t character = 0; character < _dots.size(); character++)
+    {
+        DrawCharacter(character);
+    }
+}
+
+bool Minimap::Covers(int x, int width, int y) const
+{
+    return y >= _y && y < _y + _rows && x + width > _x && x < _x + _columns;
+}
+
+void Minimap::Add(uint32_t cell, int amount)
+{
+    int x = static_cast<int>(cell % _boardWidth) / _blockWidth;
+    int y = static_cast<int>(cell / _boardWidth) / _blockHeight;
+    auto& count = _counts[x + y*_columns*2];
+    bool wasSet = count > 0;
+    count += amount;
+    if (wasSet == (count > 0))
+    {
+        return;
+    }
+    auto character = static_cast<size_t>(x/2 + (y/4)*_columns);
+    _dots[character] ^= DOT_BITS[y % 4][x % 2];
+    MarkDirty(character);
+}
+
+void Minimap::SetFood(uint32_t cell)
+{
+    auto character = GetCharacter(cell);
+    if (character == _foodCharacter)
+    {
+        return;
+    }
+    MarkDirty(_foodCharacter);
+    MarkDirty(character);
+    _foodCharacter = character;
+}
+
+size_t Minimap::GetCharacter(uint32_t cell) const
+{
+    int x = static_cast<int>(cell % _boardWidth) / _blockWidth;
+    int y = static_cast<int>(cell / _boardWidth) / _blockHeight;
+    return static_cast<size_t>(x/2 + (y/4)*_columns);
+}
+
+void Minimap::MarkDirty(size_t character)
+{
+    if (_dirty[character])
+    {
+        return;
+    }
+    _dirty[character] = true;
+    _dirtyCharacters.push_back(character);
+}
+
+void Minimap::DrawCharacter(size_t character)
+{
+    /** U+2800 + dots, the blank one still covers the board under it */
+    uint8_t dots = _dots[character];
+    char glyph[] = {
+        static_cast<char>(0xE2),
+        static_cast<char>(0xA0 | (dots >> 6)),
+        static_cast<char>(0x80 | (dots & 0x3F)),
+    };
+    auto color = character == _foodCharacter ?
+        Console::ForegroundColor::Red : Console::ForegroundColor::Green;
+    _console.PutString(
+        _x + static_cast<int>(character % _columns),
+        _y + static_cast<int>(character / _columns),
+        std::string_view(glyph, sizeof(glyph)),
+        color,
+        Console::BackgroundColor::Black);
+}
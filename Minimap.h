@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Console.h"
+#include "GameEngine.h"
+
+namespace Snake
+{
+    /**
+     * @brief The whole board scaled down to braille characters, 2x4 dots each.
+     *      A dot is set if its block of cells holds any of the snake or the food.
+     *      Blocks keep a count of such cells, so a step only touches the blocks
+     *      of the cells it changed.
+     */
+    class Minimap
+    {
+    public:
+        /** Largest size in characters */
+        static constexpr int MAX_COLUMNS = 24;
+        static constexpr int MAX_ROWS = 6;
+
+        explicit Minimap(Console& console);
+        ~Minimap() = default;
+
+        Minimap(const Minimap& other) = delete;
+        Minimap& operator=(const Minimap& other) = delete;
+        Minimap(Minimap&& other) noexcept = delete;
+        Minimap& operator=(Minimap&& other) noexcept = delete;
+
+        /**
+         * @brief Count the blocks again from the engine, in O(snake length).
+         * 
+         * @param engine 
+         * @param right The screen column just right of the minimap.
+         * @param top The screen row of the first line.
+         */
+        void Reset(const GameEngine& engine, int right, int top);
+        /**
+         * @brief Follow one step of the game.
+         * 
+         * @param delta The step.
+         * @param undo true if the step was taken back.
+         */
+        void Apply(const GameEngine::TickDelta& delta, bool undo);
+        /** Draw the characters that changed */
+        void Render();
+        /** Draw all characters */
+        void Draw();
+        /** @return true if a screen range on one row is under the minimap */
+        bool Covers(int x, int width, int y) const;
+
+    private:
+        Console& _console;
+        int _boardWidth{0};
+        /** Cells per dot */
+        int _blockWidth{1};
+        int _blockHeight{1};
+        int _columns{0};
+        int _rows{0};
+        int _x{0};
+        int _y{0};
+        /** Occupied cells per dot */
+        std::vector<uint32_t> _counts{};
+        /** Braille dot bits per character */
+        std::vector<uint8_t> _dots{};
+        /** The character with the food in it */
+        size_t _foodCharacter{0};
+        std::vector<bool> _dirty{};
+        std::vector<size_t> _dirtyCharacters{};
+
+        void Add(uint32_t cell, int amount);
+        void SetFood(uint32_t cell);
+        size_t GetCharacter(uint32_t cell) const;
+        void MarkDirty(size_t character);
+        void DrawCharacter(size_t character);
+    };
+}
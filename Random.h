@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace Snake
+{
+    /**
+     * @brief A small PCG32 generator.
+     *      Unlike std::mt19937 + std::uniform_int_distribution, the sequence
+     *      only depends on the seed, so games can be replayed on any build.
+     */
+    class Random
+    {
+    public:
+        struct State
+        {
+            uint64_t state;
+            uint64_t increment;
+        };
+
+        explicit Random(uint64_t seed = 0)
+        {
+            Seed(seed);
+        }
+
+        void Seed(uint64_t seed)
+        {
+            _state = 0;
+            _increment = (seed << 1) | 1;
+            Next();
+            _state += seed;
+            Next();
+        }
+
+        uint32_t Next()
+        {
+            uint64_t old = _state;
+            _state = old * 6364136223846793005ULL + _increment;
+            uint32_t shifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+            uint32_t rotation = static_cast<uint32_t>(old >> 59);
+            return (shifted >> rotation) | (shifted << ((-rotation) & 31));
+        }
+
+        /**
+         * @brief Uniform random number in [0, bound).
+         * 
+         * @param bound Must not be 0.
+         */
+        uint32_t Below(uint32_t bound)
+        {
+            /** Lemire's multiply and reject */
+            uint64_t product = static_cast<uint64_t>(Next()) * bound;
+            uint32_t low = static_cast<uint32_t>(product);
+            if (low < bound)
+            {
+                uint32_t threshold = -bound % bound;
+                while (low < threshold)
+                {
+                    product = static_cast<uint64_t>(Next()) * bound;
+                    low = static_cast<uint32_t>(product);
+                }
+            }
+            return static_cast<uint32_t>(product >> 32);
+        }
+
+        State GetState() const
+        {
+            return {_state, _increment};
+        }
+
+        void SetState(const State& state)
+        {
+            _state = state.state;
+            /** The increment must be odd */
+            _increment = state.increment | 1;
+        }
+
+    private:
+        uint64_t _state{0};
+        uint64_t _increment{1};
+    };
+}
@@ -0,0 +1,167 @@
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <time.h>
+#include "Replay.h"
+#include "BinaryIO.h"
+#include "Utility.h"
+#include "Constants.h"
+
+using namespace Snake;
+
+void Replay::Record(const GameEngine& engine, GameEngine::Direction previousDirection)
+{
+    ticks = engine.GetTick();
+    if (engine.GetDirection() != previousDirection)
+    {
+        turns.push_back({ticks - 1, engine.GetDirection()});
+    }
+}
+
+int Replay::Simulate() const
+{
+    GameEngine engine{level};
+    Play(engine);
+    return engine.GetScore();
+}
+
+void Replay::Play(GameEngine& engine) const
+{
+    engine.Reset(seed);
+    auto turn = turns.begin();
+    for (uint32_t tick = 0; tick < ticks && !engine.IsFinished(); tick++)
+    {
+        while (turn != turns.end() && turn->tick == tick)
+        {
+            engine.SetDirection(turn->direction);
+            turn++;
+        }
+        engine.Step();
+    }
+}
+
+std::string Replay::Save() const
+{
+    std::ostringstream name{};
+    name << time(nullptr) << "-" << std::hex << std::setw(16) << std::setfill('0') << seed << ".replay";
+    auto path = GetFilePath(name.str());
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file(path, std::ios::binary);
+    if (file.fail())
+    {
+        throw std::runtime_error("Failed to open replay file for writing");
+    }
+    Write(file);
+    file.close();
+    if (file.fail())
+    {
+        throw std::runtime_error("Failed to write replay file");
+    }
+    return name.str();
+}
+
+Replay Replay::Load(const std::string_view& name)
+{
+    std::ifstream file(GetFilePath(name), std::ios::binary);
+    if (file.fail())
+    {
+        throw std::runtime_error("Failed to open replay file for reading");
+    }
+    return Read(file);
+}
+
+void Replay::Write(std::ostream& output) const
+{
+    BinaryIO::Write(output, MAGIC);
+    BinaryIO::Write(output, VERSION);
+    BinaryIO::Write(output, seed);
+    level.Write(output);
+    BinaryIO::Write(output, ticks);
+    BinaryIO::Write(output, static_cast<uint32_t>(turns.size()));
+    WriteTurns(output, 0);
+}
+
+void Replay::WriteTurns(std::ostream& output, size_t first) const
+{
+    /** Written in chunks, one stream call per value is the bulk of the cost */
+    struct Record
+    {
+        uint32_t tick;
+        GameEngine::Direction direction;
+    } __attribute__((packed));
+    constexpr size_t CHUNK = 256;
+    Record records[CHUNK];
+    size_t count = 0;
+    for (auto turn = turns.begin() + static_cast<std::ptrdiff_t>(first); turn != turns.end(); turn++)
+    {
+        records[count++] = {turn->tick, turn->direction};
+        if (count == CHUNK)
+        {
+            output.write(reinterpret_cast<const char*>(records), sizeof(Record) * count);
+            count = 0;
+        }
+    }
+    output.write(reinterpret_cast<const char*>(records), sizeof(Record) * count);
+}
+
+Replay Replay::Read(std::istream& input)
+{
+    auto magic = BinaryIO::Read<uint32_t>(input);
+    auto version = BinaryIO::Read<uint32_t>(input);
+    if (magic != MAGIC || version < 1 || version > VERSION)
+    {
+        throw std::runtime_error("Invalid replay file format");
+    }
+    Replay replay{};
+    replay.seed = BinaryIO::Read<uint64_t>(input);
+    if (version == 1)
+    {
+        auto width = BinaryIO::Read<int32_t>(input);
+        auto height = BinaryIO::Read<int32_t>(input);
+        replay.level = Level::Open(width, height);
+    }
+    else
+    {
+        replay.level = Level::Read(input, version >= 3);
+    }
+    replay.ticks = BinaryIO::Read<uint32_t>(input);
+    replay.ReadTurns(input, BinaryIO::Read<uint32_t>(input));
+    return replay;
+}
+
+void Replay::ReadTurns(std::istream& input, uint32_t count)
+{
+    if (count > ticks)
+    {
+        throw std::runtime_error("Invalid replay file format");
+    }
+    turns.resize(count);
+    for (auto& turn : turns)
+    {
+        turn.tick = BinaryIO::Read<uint32_t>(input);
+        turn.direction = BinaryIO::Read<GameEngine::Direction>(input);
+        if (static_cast<uint8_t>(turn.direction) > static_cast<uint8_t>(GameEngine::Direction::Right))
+        {
+            throw std::runtime_error("Invalid replay file format");
+        }
+    }
+}
+
+void Replay::Remove(const std::string_view& name)
+{
+    std::error_code error{};
+    std::filesystem::remove(GetFilePath(name), error);
+}
+
+std::filesystem::path Replay::GetFilePath(const std::string_view& name)
+{
+    std::filesystem::path fileName{name};
+    /** The name comes from the leader board file, keep it inside the replay directory */
+    if (fileName.empty() || fileName != fileName.filename() ||
+        fileName == "." || fileName == "..")
+    {
+        throw std::invalid_argument("Invalid replay name");
+    }
+    return Utility::GetSaveFileRoot() / Constants::REPLAY_DIRECTORY / fileName;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+#include <istream>
+#include <ostream>
+#include "GameEngine.h"
+#include "Level.h"
+
+namespace Snake
+{
+    /**
+     * @brief Everything needed to play a game again: the level, the seed and the turns.
+     */
+    struct Replay
+    {
+        struct Turn
+        {
+            /** The step that uses the new direction */
+            uint32_t tick;
+            GameEngine::Direction direction;
+        };
+
+        uint64_t seed{0};
+        Level level{};
+        /** Steps taken, including the last one */
+        uint32_t ticks{0};
+        std::vector<Turn> turns{};
+
+        /**
+         * @brief Record the step the engine just took.
+         * 
+         * @param engine 
+         * @param previousDirection The direction before the step.
+         */
+        void Record(const GameEngine& engine, GameEngine::Direction previousDirection);
+        /**
+         * @brief Play the game again without any output.
+         * 
+         * @return int The final score.
+         */
+        int Simulate() const;
+        /**
+         * @brief Play the game again on an engine of the level, up to the last step recorded.
+         * 
+         * @param engine 
+         */
+        void Play(GameEngine& engine) const;
+        /**
+         * @brief Save to the replay directory.
+         * 
+         * @return std::string The file name, relative to the replay directory.
+         */
+        std::string Save() const;
+        static Replay Load(const std::string_view& name);
+        void Write(std::ostream& output) const;
+        static Replay Read(std::istream& input);
+        static void Remove(const std::string_view& name);
+        /** The turns from first on alone, for checkpoints that add them as the game goes */
+        void WriteTurns(std::ostream& output, size_t first) const;
+        /** Read count turns written by WriteTurns, after ticks is set */
+        void ReadTurns(std::istream& input, uint32_t count);
+    private:
+        static constexpr uint32_t MAGIC = 0x59504C52; /** "RLPY" */
+        /**
+         * Version 2 replaced the board size with the level, version 1 is read as an open board.
+         * Version 3 added the spawns of the level, earlier ones start at the default spawn.
+         */
+        static constexpr uint32_t VERSION = 3;
+
+        static std::filesystem::path GetFilePath(const std::string_view& name);
+    };
+}
@@ -0,0 +1,76 @@
+#include <vector>
+#include <string>
+#include "ScoreVerifier.h"
+#include "LeaderBoard.h"
+#include "Replay.h"
+#include "ThreadPool.h"
+
+using namespace Snake;
+
+size_t ScoreVerifier::VerifyLeaderBoard(std::ostream& output)
+{
+    auto scores = LeaderBoard::LoadScores();
+    struct Result
+    {
+        bool checked{false};
+        int score{0};
+        std::string error{};
+    };
+    /** One slot per score, so the workers never share anything */
+    std::vector<Result> results(scores.size());
+    {
+        ThreadPool pool{};
+        for (size_t i = 0; i < scores.size(); i++)
+        {
+            if (scores[i].replay.empty())
+            {
+                continue;
+            }
+            pool.Submit([&scores, &results, i](){
+                auto& result = results[i];
+                result.checked = true;
+                try
+                {
+                    result.score = Replay::Load(scores[i].replay).Simulate();
+                }
+                catch (const std::exception& e)
+                {
+                    result.error = e.what();
+                }
+            });
+        }
+        pool.Wait();
+    }
+    size_t failed = 0;
+    size_t verified = 0;
+    size_t unchecked = 0;
+    for (size_t i = 0; i < scores.size(); i++)
+    {
+        const auto& score = scores[i];
+        const auto& result = results[i];
+        if (!result.checked)
+        {
+            unchecked++;
+            continue;
+        }
+        if (!result.error.empty())
+        {
+            failed++;
+            output << "#" << (i + 1) << " " << score.name << " " << score.score
+                << ": " << result.error << std::endl;
+        }
+        else if (result.score != score.score)
+        {
+            failed++;
+            output << "#" << (i + 1) << " " << score.name << " " << score.score
+                << ": replay scores " << result.score << std::endl;
+        }
+        else
+        {
+            verified++;
+        }
+    }
+    output << verified << " verified, " << failed << " failed, "
+        << unchecked << " without replay" << std::endl;
+    return failed;
+}
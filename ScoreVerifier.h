@@ -0,0 +1,19 @@
+#pragma once
+
+#include <ostream>
+
+namespace Snake
+{
+    class ScoreVerifier
+    {
+    public:
+        /**
+         * @brief Replay every leader board score that has a replay and
+         *      compare the result with the saved score.
+         * 
+         * @param output The report is written here.
+         * @return size_t The number of scores that failed verification.
+         */
+        static size_t VerifyLeaderBoard(std::ostream& output);
+    };
+}
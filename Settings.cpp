@@ -1,8 +1,10 @@
 #include <nlohmann/json.hpp>
 #include <fstream>
+#include <algorithm>
 #include "Settings.h"
 #include "Utility.h"
 #include "Constants.h"
+#include "Autopilot.h"
 
 using namespace Snake;
 
@@ -30,13 +32,79 @@ Settings Settings::Load()
     {
         settings.useSimpleGraphics = saved[USE_SIMPLE_GRAPHICS].get<bool>();
     }
-    if (saved.contains(GAME_SPEED) && saved[GAME_SPEED].is_number_integer())
+    if (saved.contains(USE_HALF_BLOCKS) && saved[USE_HALF_BLOCKS].is_boolean())
     {
+        settings.useHalfBlocks = saved[USE_HALF_BLOCKS].get<bool>();
+    }
+    if (saved.contains(TICK_RATE) && saved[TICK_RATE].is_number_integer())
+    {
+        int tickRate = saved[TICK_RATE].get<int>();
+        if (tickRate >= TICK_RATE_MIN && tickRate <= TICK_RATE_MAX)
+        {
+            settings.tickRate = tickRate;
+        }
+    }
+    else if (saved.contains(GAME_SPEED) && saved[GAME_SPEED].is_number_integer())
+    {
+        /** Slow, Normal, Fast and Very fast were 300, 200, 133 and 88 ms per tick */
+        constexpr int gameSpeedTickRates[] = {3, 5, 8, 11};
         int gameSpeedNumber = saved[GAME_SPEED].get<int>();
-        if (gameSpeedNumber >= 0 && 
-            gameSpeedNumber < static_cast<int>(GameSpeed::Count))
+        if (gameSpeedNumber >= 0 && gameSpeedNumber < 4)
         {
-            settings.gameSpeed = static_cast<GameSpeed>(gameSpeedNumber);
+            settings.tickRate = gameSpeedTickRates[gameSpeedNumber];
+        }
+    }
+    if (saved.contains(HIGH_REFRESH) && saved[HIGH_REFRESH].is_boolean())
+    {
+        settings.highRefresh = saved[HIGH_REFRESH].get<bool>();
+    }
+    if (saved.contains(HIGH_REFRESH_RATE) && saved[HIGH_REFRESH_RATE].is_number_integer())
+    {
+        int highRefreshRate = saved[HIGH_REFRESH_RATE].get<int>();
+        if (highRefreshRate >= HIGH_REFRESH_RATE_MIN && highRefreshRate <= HIGH_REFRESH_RATE_MAX)
+        {
+            settings.highRefreshRate = highRefreshRate;
+        }
+    }
+    if (saved.contains(PRACTICE_MODE) && saved[PRACTICE_MODE].is_boolean())
+    {
+        settings.practiceMode = saved[PRACTICE_MODE].get<bool>();
+    }
+    if (saved.contains(BOARD_WIDTH) && saved[BOARD_WIDTH].is_number_integer() &&
+        saved.contains(BOARD_HEIGHT) && saved[BOARD_HEIGHT].is_number_integer())
+    {
+        int boardWidth = saved[BOARD_WIDTH].get<int>();
+        int boardHeight = saved[BOARD_HEIGHT].get<int>();
+        if (boardWidth >= BOARD_SIZE_MIN && boardWidth <= BOARD_SIZE_MAX &&
+            boardHeight >= BOARD_SIZE_MIN && boardHeight <= BOARD_SIZE_MAX)
+        {
+            settings.boardWidth = boardWidth;
+            settings.boardHeight = boardHeight;
+        }
+    }
+    if (saved.contains(AUTOPILOT) && saved[AUTOPILOT].is_string())
+    {
+        auto autopilot = saved[AUTOPILOT].get<std::string>();
+        if (autopilot.empty() || Autopilot::ParseKey(autopilot).has_value())
+        {
+            settings.autopilot = autopilot;
+        }
+    }
+    if (saved.contains(LEVEL) && saved[LEVEL].is_string())
+    {
+        auto level = settings;
+        level.level = saved[LEVEL].get<std::string>();
+        try
+        {
+            /** Only look for the file, it is read when a game is started on it */
+            if (level.HasLevel())
+            {
+                settings.level = level.level;
+            }
+        }
+        catch (const std::exception&)
+        {
+            /** Not a level name, new games are played on an open board */
         }
     }
     return settings;
@@ -46,18 +114,125 @@ void Settings::Save() const
 {
     nlohmann::json saved;
     saved[USE_SIMPLE_GRAPHICS] = useSimpleGraphics;
-    saved[GAME_SPEED] = static_cast<int>(gameSpeed);
+    saved[USE_HALF_BLOCKS] = useHalfBlocks;
+    saved[TICK_RATE] = tickRate;
+    saved[HIGH_REFRESH] = highRefresh;
+    saved[HIGH_REFRESH_RATE] = highRefreshRate;
+    saved[PRACTICE_MODE] = practiceMode;
+    saved[BOARD_WIDTH] = boardWidth;
+    saved[BOARD_HEIGHT] = boardHeight;
+    saved[AUTOPILOT] = autopilot;
+    saved[LEVEL] = level;
     auto path = GetFilePath();
-    std::ofstream file(path);
+    auto temporaryPath = path;
+    temporaryPath += ".tmp";
+    std::ofstream file(temporaryPath);
     if (file.fail())
     {
         throw std::runtime_error("Failed to open settings file");
     }
     file << saved.dump(4);
     file.close();
+    if (file.fail())
+    {
+        throw std::runtime_error("Failed to write settings file");
+    }
+    std::filesystem::rename(temporaryPath, path);
+}
+
+int Settings::GetEffectiveTickRate() const
+{
+    return highRefresh ? highRefreshRate : tickRate;
+}
+
+std::shared_ptr<const CompiledLevel> Settings::GetLevel() const
+{
+    if (level.empty())
+    {
+        return CompiledLevel::Compile(Level::Open(boardWidth, boardHeight));
+    }
+    if (auto number = GetBuiltInLevel(); number != 0)
+    {
+        return CompiledLevel::Compile(Level::BuiltIn(number));
+    }
+    auto path = GetLevelPath(level);
+    auto compiledPath = GetCompiledLevelPath(path);
+    std::error_code error{};
+    auto compiledTime = std::filesystem::last_write_time(compiledPath, error);
+    if (!error)
+    {
+        /** A level edited since it was compiled is read from the text */
+        auto time = std::filesystem::last_write_time(path, error);
+        if (error || time <= compiledTime)
+        {
+            return CompiledLevel::Map(compiledPath);
+        }
+    }
+    return CompiledLevel::Compile(Level::Load(path));
+}
+
+bool Settings::HasLevel() const
+{
+    if (level.empty() || GetBuiltInLevel() != 0)
+    {
+        return true;
+    }
+    auto path = GetLevelPath(level);
+    return std::filesystem::exists(path) || std::filesystem::exists(GetCompiledLevelPath(path));
+}
+
+std::filesystem::file_time_type Settings::GetLevelTime() const
+{
+    auto time = std::filesystem::file_time_type::min();
+    if (level.empty() || GetBuiltInLevel() != 0)
+    {
+        return time;
+    }
+    auto path = GetLevelPath(level);
+    for (const auto& file : {path, GetCompiledLevelPath(path)})
+    {
+        std::error_code error{};
+        auto fileTime = std::filesystem::last_write_time(file, error);
+        if (!error)
+        {
+            time = std::max(time, fileTime);
+        }
+    }
+    return time;
+}
+
+int Settings::GetBuiltInLevel() const
+{
+    for (int number = 1; number <= Level::BUILT_IN_COUNT; number++)
+    {
+        if (level == std::to_string(number))
+        {
+            return number;
+        }
+    }
+    return 0;
 }
 
 std::filesystem::path Settings::GetFilePath()
 {
     return Utility::GetSaveFileRoot() / Constants::SETTINGS_FILE;
 }
+
+std::filesystem::path Settings::GetLevelPath(const std::string& name)
+{
+    std::filesystem::path fileName{name};
+    /** Keep it inside the level directory */
+    if (fileName != fileName.filename() || fileName == "." || fileName == "..")
+    {
+        throw std::invalid_argument("Invalid level name");
+    }
+    fileName += Constants::LEVEL_EXTENSION;
+    return Utility::GetSaveFileRoot() / Constants::LEVEL_DIRECTORY / fileName;
+}
+
+std::filesystem::path Settings::GetCompiledLevelPath(const std::filesystem::path& levelPath)
+{
+    auto compiledPath = levelPath;
+    compiledPath.replace_extension(CompiledLevel::EXTENSION);
+    return compiledPath;
+}
@@ -1,28 +1,78 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
+#include <string>
 #include <string_view>
+#include "CompiledLevel.h"
 
 namespace Snake
 {
     struct Settings
     {
-        enum class GameSpeed
-        {
-            Slow = 0,
-            Normal = 1,
-            Fast = 2,
-            VeryFast = 3,
-            Count = 4
-        };
+        static constexpr int TICK_RATE_MIN = 1;
+        static constexpr int TICK_RATE_MAX = 30;
+        static constexpr int HIGH_REFRESH_RATE_MIN = 50;
+        static constexpr int HIGH_REFRESH_RATE_MAX = 1000;
+        static constexpr int BOARD_SIZE_MIN = 10;
+        static constexpr int BOARD_SIZE_MAX = 4096;
+
         bool useSimpleGraphics{false};
-        GameSpeed gameSpeed{GameSpeed::Normal};
+        /** Stack two cells in one terminal cell, four times the cells on the screen */
+        bool useHalfBlocks{false};
+        /** Ticks per second */
+        int tickRate{5};
+        /** Use highRefreshRate instead of tickRate. For AI and benchmark runs. */
+        bool highRefresh{false};
+        /** Ticks per second in high refresh mode */
+        int highRefreshRate{200};
+        /** Hold R to rewind. Practice games are not ranked. */
+        bool practiceMode{false};
+        /** In cells. The default fills an 80x25 terminal. */
+        int boardWidth{39};
+        int boardHeight{22};
+        /** The strategy that plays new and resumed games, empty to play by hand */
+        std::string autopilot{};
+        /**
+         * Level of new games: empty for an open board of the board size,
+         * a number for a map of the original game, or a file in the level directory.
+         * A compiled file of the same name is mapped instead of reading the text,
+         * unless the text was changed after it.
+         */
+        std::string level{};
+
+        int GetEffectiveTickRate() const;
+        /** @throws if the level file is gone or broken, loading only looks for it */
+        std::shared_ptr<const CompiledLevel> GetLevel() const;
+        /** Whether the level is an open board, a built in map, or a file that is there */
+        bool HasLevel() const;
+        /** When the level files last changed, the oldest time for a level without files */
+        std::filesystem::file_time_type GetLevelTime() const;
         static Settings Load();
+        /**
+         * @brief Replace the settings file atomically,
+         *      so it is never seen half written.
+         */
         void Save() const;
+        bool operator==(const Settings& other) const = default;
     private:
         static constexpr std::string_view USE_SIMPLE_GRAPHICS = "useSimpleGraphics";
+        static constexpr std::string_view USE_HALF_BLOCKS = "useHalfBlocks";
+        /** Replaced by TICK_RATE. Only read to migrate old settings. */
         static constexpr std::string_view GAME_SPEED = "gameSpeed";
+        static constexpr std::string_view TICK_RATE = "tickRate";
+        static constexpr std::string_view HIGH_REFRESH = "highRefresh";
+        static constexpr std::string_view HIGH_REFRESH_RATE = "highRefreshRate";
+        static constexpr std::string_view PRACTICE_MODE = "practiceMode";
+        static constexpr std::string_view BOARD_WIDTH = "boardWidth";
+        static constexpr std::string_view BOARD_HEIGHT = "boardHeight";
+        static constexpr std::string_view AUTOPILOT = "autopilot";
+        static constexpr std::string_view LEVEL = "level";
 
         static std::filesystem::path GetFilePath();
+        /** The number of a map of the original game, 0 if the level is not one */
+        int GetBuiltInLevel() const;
+        static std::filesystem::path GetLevelPath(const std::string& name);
+        static std::filesystem::path GetCompiledLevelPath(const std::filesystem::path& levelPath);
     };
 }
@@ -0,0 +1,200 @@
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <climits>
+#include <stdexcept>
+#include "SettingsService.h"
+#include "Utility.h"
+#include "Constants.h"
+
+using namespace Snake;
+
+SettingsService::SettingsService(Tev& tev)
+    : _tev(tev)
+{
+    _settings = Settings::Load();
+    /** Watch the directory, the file is replaced on every write */
+    _inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotifyFd == -1)
+    {
+        throw std::runtime_error("inotify_init1 failed");
+    }
+    int rc = inotify_add_watch(
+        _inotifyFd,
+        Utility::GetSaveFileRoot().c_str(),
+        IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE);
+    if (rc == -1)
+    {
+        close(_inotifyFd);
+        throw std::runtime_error("inotify_add_watch failed");
+    }
+    _watchHandler = _tev.SetReadHandler(_inotifyFd, std::bind(&SettingsService::WatchHandler, this));
+    _writer = std::thread(&SettingsService::Writer, this);
+}
+
+SettingsService::~SettingsService()
+{
+    try
+    {
+        Close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void SettingsService::Close()
+{
+    if (_closed)
+    {
+        return;
+    }
+    _closed = true;
+    _watchHandler.Clear();
+    close(_inotifyFd);
+    _inotifyFd = -1;
+    {
+        std::lock_guard lock{_mutex};
+        _stopping = true;
+    }
+    _writeRequested.notify_one();
+    _writer.join();
+}
+
+const Settings& SettingsService::Get() const
+{
+    return _settings;
+}
+
+void SettingsService::Set(const Settings& settings)
+{
+    if (settings == _settings)
+    {
+        return;
+    }
+    _settings = settings;
+    {
+        std::lock_guard lock{_mutex};
+        _pendingWrite = settings;
+    }
+    _writeRequested.notify_one();
+}
+
+std::shared_ptr<const CompiledLevel> SettingsService::GetLevel()
+{
+    auto time = std::filesystem::file_time_type::min();
+    try
+    {
+        time = _settings.GetLevelTime();
+    }
+    catch (const std::exception&)
+    {
+        /** Not a level name, GetLevel throws below */
+    }
+    if (_level != nullptr &&
+        _levelSettings.level == _settings.level &&
+        _levelSettings.boardWidth == _settings.boardWidth &&
+        _levelSettings.boardHeight == _settings.boardHeight &&
+        _levelTime == time)
+    {
+        return _level;
+    }
+    try
+    {
+        _level = _settings.GetLevel();
+    }
+    catch (const std::exception&)
+    {
+        auto open = _settings;
+        open.level.clear();
+        _level = open.GetLevel();
+    }
+    _levelSettings = _settings;
+    _levelTime = time;
+    return _level;
+}
+
+void SettingsService::WatchHandler()
+{
+    alignas(inotify_event) char buffer[sizeof(inotify_event) + NAME_MAX + 1];
+    bool changed = false;
+    while (true)
+    {
+        ssize_t bytesRead = read(_inotifyFd, buffer, sizeof(buffer));
+        if (bytesRead <= 0)
+        {
+            break;
+        }
+        for (ssize_t offset = 0; offset < bytesRead;)
+        {
+            auto event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (event->len > 0 && Constants::SETTINGS_FILE == event->name)
+            {
+                changed = true;
+            }
+            offset += sizeof(inotify_event) + event->len;
+        }
+    }
+    if (changed)
+    {
+        Reload();
+    }
+}
+
+void SettingsService::Reload()
+{
+    Settings loaded{};
+    try
+    {
+        loaded = Settings::Load();
+    }
+    catch (const std::exception&)
+    {
+        /** Keep what we have until the file is fixed */
+        return;
+    }
+    std::lock_guard lock{_mutex};
+    if (_pendingWrite.has_value())
+    {
+        /** Our write is newer */
+        return;
+    }
+    if (_lastWrite.has_value() && loaded == _lastWrite.value())
+    {
+        /** Our own write */
+        return;
+    }
+    _settings = loaded;
+    _lastWrite.reset();
+}
+
+void SettingsService::Writer()
+{
+    std::unique_lock lock{_mutex};
+    while (true)
+    {
+        _writeRequested.wait(lock, [this](){
+            return _stopping || _pendingWrite.has_value();
+        });
+        if (!_pendingWrite.has_value())
+        {
+            /** Stopping */
+            return;
+        }
+        auto settings = _pendingWrite.value();
+        lock.unlock();
+        try
+        {
+            settings.Save();
+        }
+        catch (const std::exception&)
+        {
+            /** The settings still apply to this run */
+        }
+        lock.lock();
+        _lastWrite = settings;
+        if (_pendingWrite == settings)
+        {
+            _pendingWrite.reset();
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <tev-cpp/Tev.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include "Settings.h"
+
+namespace Snake
+{
+    /**
+     * @brief Keeps the settings in memory.
+     *      Changes are written back on a background thread.
+     *      The file is only read again when it is changed by someone else.
+     */
+    class SettingsService
+    {
+    public:
+        SettingsService(Tev& tev);
+        ~SettingsService();
+
+        SettingsService(const SettingsService& other) = delete;
+        SettingsService& operator=(const SettingsService& other) = delete;
+        SettingsService(SettingsService&& other) noexcept = delete;
+        SettingsService& operator=(SettingsService&& other) noexcept = delete;
+
+        /**
+         * @brief Stop watching the file and finish the pending write.
+         */
+        void Close();
+        const Settings& Get() const;
+        void Set(const Settings& settings);
+        /**
+         * @brief The level of new games, compiled again only when it was changed
+         *      in the settings or on the disk. A level file that cannot be read anymore
+         *      gives an open board, as if it had been missing when the settings were loaded.
+         */
+        std::shared_ptr<const CompiledLevel> GetLevel();
+
+    private:
+        Tev& _tev;
+        bool _closed{false};
+        Settings _settings{};
+        int _inotifyFd{-1};
+        Tev::FdHandler _watchHandler{};
+        /** The last level compiled, with the settings and the file time it was compiled for */
+        std::shared_ptr<const CompiledLevel> _level{};
+        Settings _levelSettings{};
+        std::filesystem::file_time_type _levelTime{};
+
+        /** Shared with the writer thread */
+        std::mutex _mutex{};
+        std::condition_variable _writeRequested{};
+        std::optional<Settings> _pendingWrite{};
+        /** The last settings we wrote, to recognize our own changes */
+        std::optional<Settings> _lastWrite{};
+        bool _stopping{false};
+        std::thread _writer{};
+
+        void WatchHandler();
+        void Reload();
+        void Writer();
+    };
+}
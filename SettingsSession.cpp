@@ -1,12 +1,16 @@
 #include "SettingsSession.h"
+#include <algorithm>
 #include "Utility.h"
 #include "Constants.h"
+#include "Autopilot.h"
+#include "Level.h"
 
 using namespace Snake;
 
-SettingsSession::SettingsSession(Console& console)
+SettingsSession::SettingsSession(Console& console, SettingsService& settingsService)
     : _console(console),
-      _menu(console, 10, 2)
+      _menu(console, 10, 2),
+      _settingsService(settingsService)
 {
 }
 
@@ -23,35 +27,108 @@ void SettingsSession::Activate(const int& params)
         return;
     }
     _active = true;
+    /** The screen is replaced in one frame */
+    _console.BeginFrame();
     _console.Clear();
-    /** Draw boarder */
-    Utility::DrawBox(
-        _console,
-        0, 0,
-        Constants::DISPLAY_WIDTH - 1,
-        Constants::DISPLAY_HEIGHT - 1);
+    DrawBorder();
     /** Init Menu */
-    _settings = Settings::Load();
+    _settings = _settingsService.Get();
     _menu.AddOption(std::make_shared<SettingsSession::Menu::BoolOption>(
         "Use simple graphics",
         _settings.useSimpleGraphics,
         [this](bool value){
             _settings.useSimpleGraphics = value;
         }));
-    _menu.AddOption(std::make_shared<SettingsSession::Menu::EnumOption<Settings::GameSpeed>>(
-        "Game speed",
-        std::vector<SettingsSession::Menu::EnumOption<Settings::GameSpeed>::SubOption>{
-            {"Slow", Settings::GameSpeed::Slow},
-            {"Normal", Settings::GameSpeed::Normal},
-            {"Fast", Settings::GameSpeed::Fast},
-            {"Very fast", Settings::GameSpeed::VeryFast}
-        },
-        _settings.gameSpeed,
-        [this](const auto& value){
-            _settings.gameSpeed = value;
+    _menu.AddOption(std::make_shared<SettingsSession::Menu::BoolOption>(
+        "Use half block graphics (4x the cells)",
+        _settings.useHalfBlocks,
+        [this](bool value){
+            _settings.useHalfBlocks = value;
+        }));
+    _menu.AddOption(std::make_shared<SettingsSession::Menu::NumericOption>(
+        "Game speed (ticks per second)",
+        _settings.tickRate,
+        Settings::TICK_RATE_MIN, Settings::TICK_RATE_MAX, 1,
+        [this](int value){
+            _settings.tickRate = value;
+        }));
+    _menu.AddOption(std::make_shared<SettingsSession::Menu::BoolOption>(
+        "High refresh mode",
+        _settings.highRefresh,
+        [this](bool value){
+            _settings.highRefresh = value;
+        }));
+    _menu.AddOption(std::make_shared<SettingsSession::Menu::NumericOption>(
+        "High refresh speed (ticks per second)",
+        _settings.highRefreshRate,
+        Settings::HIGH_REFRESH_RATE_MIN, Settings::HIGH_REFRESH_RATE_MAX, 50,
+        [this](int value){
+            _settings.highRefreshRate = value;
+        }));
+    _menu.AddOption(std::make_shared<SettingsSession::Menu::BoolOption>(
+        "Practice mode (hold R to rewind, not ranked)",
+        _settings.practiceMode,
+        [this](bool value){
+            _settings.practiceMode = value;
+        }));
+    typedef std::pair<int, int> BoardSize;
+    typedef SettingsSession::Menu::EnumOption<BoardSize> BoardSizeOption;
+    std::vector<BoardSizeOption::SubOption> boardSizes{
+        {"39 x 22, fits the screen", {39, 22}},
+        {"64 x 64", {64, 64}},
+        {"256 x 256", {256, 256}},
+        {"1024 x 1024", {1024, 1024}},
+        {"4096 x 4096", {4096, 4096}},
+    };
+    BoardSize boardSize{_settings.boardWidth, _settings.boardHeight};
+    if (std::none_of(boardSizes.begin(), boardSizes.end(), [&boardSize](const auto& option){
+            return option.GetValue() == boardSize;
+        }))
+    {
+        /** Set in the settings file */
+        boardSizes.emplace_back(
+            std::to_string(boardSize.first) + " x " + std::to_string(boardSize.second),
+            boardSize);
+    }
+    _menu.AddOption(std::make_shared<BoardSizeOption>(
+        "Board size (new games)",
+        boardSizes,
+        boardSize,
+        [this](const BoardSize& value){
+            _settings.boardWidth = value.first;
+            _settings.boardHeight = value.second;
+        }));
+    /** A level file named in the settings file shows as 0 until another level is picked */
+    int levelNumber = 0;
+    for (int number = 1; number <= Level::BUILT_IN_COUNT; number++)
+    {
+        if (_settings.level == std::to_string(number))
+        {
+            levelNumber = number;
         }
-    ));
+    }
+    _menu.AddOption(std::make_shared<SettingsSession::Menu::NumericOption>(
+        "Level (new games, 0 for an open board)",
+        levelNumber,
+        0, Level::BUILT_IN_COUNT, 1,
+        [this](int value){
+            _settings.level = value == 0 ? "" : std::to_string(value);
+        }));
+    typedef SettingsSession::Menu::EnumOption<std::string> AutopilotOption;
+    std::vector<AutopilotOption::SubOption> autopilots{{"Off", ""}};
+    for (auto strategy : Autopilot::STRATEGIES)
+    {
+        autopilots.emplace_back(Autopilot::GetName(strategy), std::string{Autopilot::GetKey(strategy)});
+    }
+    _menu.AddOption(std::make_shared<AutopilotOption>(
+        "Autopilot (A in game, not ranked)",
+        autopilots,
+        _settings.autopilot,
+        [this](const std::string& value){
+            _settings.autopilot = value;
+        }));
     _menu.BootStrap();
+    _console.EndFrame();
     _console.SetKeyHandler(Console::EscapedKeys::Up, [this](){
         _menu.SelectPrevious();
     });
@@ -61,9 +138,28 @@ void SettingsSession::Activate(const int& params)
     _console.SetKeyHandler(' ', [this](){
         _menu.Toggle();
     });
+    _console.SetKeyHandler(Console::EscapedKeys::Right, [this](){
+        _menu.Increase();
+    });
+    _console.SetKeyHandler(Console::EscapedKeys::Left, [this](){
+        _menu.Decrease();
+    });
     _console.SetKeyHandler('\x1b', [this](){
         SwitchBack(_settings);
     });
+    _console.SetResizeHandler([this](){
+        DrawBorder();
+        _menu.ReDraw();
+    });
+}
+
+void SettingsSession::DrawBorder()
+{
+    Utility::DrawBox(
+        _console,
+        0, 0,
+        _console.GetWidth() - 1,
+        _console.GetHeight() - 1);
 }
 
 void SettingsSession::Deactivate()
@@ -77,8 +173,11 @@ void SettingsSession::Deactivate()
     _console.SetKeyHandler(Console::EscapedKeys::Up, nullptr);
     _console.SetKeyHandler(Console::EscapedKeys::Down, nullptr);
     _console.SetKeyHandler(' ', nullptr);
+    _console.SetKeyHandler(Console::EscapedKeys::Right, nullptr);
+    _console.SetKeyHandler(Console::EscapedKeys::Left, nullptr);
+    _console.SetResizeHandler(nullptr);
     _menu.Clear();
-    _settings.Save();
+    _settingsService.Set(_settings);
 }
 
 void SettingsSession::Close()
@@ -108,6 +207,16 @@ void SettingsSession::Menu::Clear()
     _options.clear();
 }
 
+void SettingsSession::Menu::ReDraw()
+{
+    /** Options keep their state, Init only places and draws them */
+    size_t y = _y;
+    for (const auto& option : _options)
+    {
+        y += option->Init(_console, _x, y);
+    }
+}
+
 void SettingsSession::Menu::BootStrap()
 {
     if (_options.empty())
@@ -147,6 +256,16 @@ void SettingsSession::Menu::Toggle()
     _selectedOption.Get()->get()->Toggle();
 }
 
+void SettingsSession::Menu::Increase()
+{
+    _selectedOption.Get()->get()->Increase();
+}
+
+void SettingsSession::Menu::Decrease()
+{
+    _selectedOption.Get()->get()->Decrease();
+}
+
 void SettingsSession::Menu::SelectedOption::Set(
     const std::vector<std::shared_ptr<SettingsSession::Menu::BaseOption>>::iterator& option, bool selectFirst)
 {
@@ -245,6 +364,14 @@ void SettingsSession::Menu::BoolOption::Toggle()
     _setter(_value);
 }
 
+void SettingsSession::Menu::BoolOption::Increase()
+{
+}
+
+void SettingsSession::Menu::BoolOption::Decrease()
+{
+}
+
 void SettingsSession::Menu::BoolOption::Render()
 {
     auto selector = std::string(_value ? STR_ON : STR_OFF);
@@ -256,6 +383,107 @@ void SettingsSession::Menu::BoolOption::Render()
     _console->PutString(_x + selector.length(), _y, " " + _description);
 }
 
+SettingsSession::Menu::NumericOption::NumericOption(
+    const std::string_view& description,
+    int value, int min, int max, int step,
+    std::function<void(int)> setter)
+    : _description(description),
+      _value(value),
+      _min(min),
+      _max(max),
+      _step(step),
+      _setter(setter)
+{
+}
+
+int SettingsSession::Menu::NumericOption::Init(
+    Console& console, size_t x, size_t y)
+{
+    _console = &console;
+    _x = x;
+    _y = y;
+    Render();
+    return 1;
+}
+
+void SettingsSession::Menu::NumericOption::SelectFirst()
+{
+    if (_selected)
+    {
+        return;
+    }
+    _selected = true;
+    Render();
+}
+
+void SettingsSession::Menu::NumericOption::SelectLast()
+{
+    SelectFirst();
+}
+
+bool SettingsSession::Menu::NumericOption::SelectNext()
+{
+    return true;
+}
+
+bool SettingsSession::Menu::NumericOption::SelectPrevious()
+{
+    return true;
+}
+
+void SettingsSession::Menu::NumericOption::Deselect()
+{
+    if (!_selected)
+    {
+        return;
+    }
+    _selected = false;
+    Render();
+}
+
+void SettingsSession::Menu::NumericOption::Toggle()
+{
+    Set(_value >= _max ? _min : _value + _step);
+}
+
+void SettingsSession::Menu::NumericOption::Increase()
+{
+    Set(_value + _step);
+}
+
+void SettingsSession::Menu::NumericOption::Decrease()
+{
+    Set(_value - _step);
+}
+
+void SettingsSession::Menu::NumericOption::Set(int value)
+{
+    value = std::clamp(value, _min, _max);
+    if (value == _value)
+    {
+        return;
+    }
+    _value = value;
+    Render();
+    _setter(_value);
+}
+
+void SettingsSession::Menu::NumericOption::Render()
+{
+    auto number = std::to_string(_value);
+    if (number.length() < VALUE_WIDTH)
+    {
+        number.insert(0, VALUE_WIDTH - number.length(), ' ');
+    }
+    auto selector = "<" + number + ">";
+    Console::ForegroundColor fg = _selected ?
+        Console::ForegroundColor::Black : Console::ForegroundColor::Default;
+    Console::BackgroundColor bg = _selected ?
+        Console::BackgroundColor::White : Console::BackgroundColor::Default;
+    _console->PutString(_x, _y, selector, fg, bg);
+    _console->PutString(_x + selector.length(), _y, " " + _description);
+}
+
 template<typename T>
 SettingsSession::Menu::EnumOption<T>::EnumOption(
     const std::string_view& description,
@@ -347,6 +575,16 @@ void SettingsSession::Menu::EnumOption<T>::Toggle()
     _setter(_value);
 }
 
+template<typename T>
+void SettingsSession::Menu::EnumOption<T>::Increase()
+{
+}
+
+template<typename T>
+void SettingsSession::Menu::EnumOption<T>::Decrease()
+{
+}
+
 template<typename T>
 SettingsSession::Menu::EnumOption<T>::SelectedOption& SettingsSession::Menu::EnumOption<T>::SelectedOption::operator=(
     const std::vector<SettingsSession::Menu::EnumOption<T>::SubOption>::iterator& option)
@@ -417,6 +655,12 @@ SettingsSession::Menu::EnumOption<T>::SubOption::SubOption(
 {
 }
 
+template<typename T>
+const T& SettingsSession::Menu::EnumOption<T>::SubOption::GetValue() const
+{
+    return _value;
+}
+
 template<typename T>
 void SettingsSession::Menu::EnumOption<T>::SubOption::Init(
     Console& console, size_t x, size_t y)
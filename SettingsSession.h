@@ -6,13 +6,14 @@
 #include "Session.h"
 #include "Console.h"
 #include "Settings.h"
+#include "SettingsService.h"
 
 namespace Snake
 {
     class SettingsSession : public Session<int, Settings>
     {
     public:
-        SettingsSession(Console& console);
+        SettingsSession(Console& console, SettingsService& settingsService);
         ~SettingsSession() override;
 
         SettingsSession(const SettingsSession&) = delete;
@@ -25,6 +26,8 @@ namespace Snake
         void Close() override;
 
     private:
+        void DrawBorder();
+
         class Menu
         {
         public:
@@ -42,6 +45,8 @@ namespace Snake
                 virtual void SelectLast() = 0;
                 virtual void Deselect() = 0;
                 virtual void Toggle() = 0;
+                virtual void Increase() = 0;
+                virtual void Decrease() = 0;
             };
 
             class BoolOption : public BaseOption
@@ -58,6 +63,8 @@ namespace Snake
                 void SelectLast() override;
                 void Deselect() override;
                 void Toggle() override;
+                void Increase() override;
+                void Decrease() override;
 
             private:
                 static constexpr std::string_view STR_ON = "[*]";
@@ -74,6 +81,45 @@ namespace Snake
                 size_t _y{0};            
             };
 
+            class NumericOption : public BaseOption
+            {
+            public:
+                NumericOption(
+                    const std::string_view& description,
+                    int value, int min, int max, int step,
+                    std::function<void(int)> setter);
+                ~NumericOption() override = default;
+
+            protected:
+                int Init(Console& console, size_t x, size_t y);
+                void SelectFirst() override;
+                bool SelectNext() override;
+                bool SelectPrevious() override;
+                void SelectLast() override;
+                void Deselect() override;
+                /** Step up, wrapping around to the minimum */
+                void Toggle() override;
+                void Increase() override;
+                void Decrease() override;
+
+            private:
+                static constexpr size_t VALUE_WIDTH = 4;
+
+                void Set(int value);
+                void Render();
+
+                std::string _description;
+                int _value;
+                int _min;
+                int _max;
+                int _step;
+                std::function<void(int)> _setter;
+                bool _selected{false};
+                Console* _console{nullptr};
+                size_t _x{0};
+                size_t _y{0};
+            };
+
             template <typename T>
             class EnumOption : public BaseOption
             {
@@ -84,6 +130,7 @@ namespace Snake
                 public:
                     SubOption(const std::string_view& description, const T& value);
                     ~SubOption() = default;
+                    const T& GetValue() const;
 
                 private:
                     static constexpr std::string_view STR_ON = "(*)";
@@ -120,6 +167,8 @@ namespace Snake
                 void SelectLast() override;
                 void Deselect() override;
                 void Toggle() override;
+                void Increase() override;
+                void Decrease() override;
 
             private:
                 class SelectedOption
@@ -163,9 +212,13 @@ namespace Snake
             void AddOption(std::shared_ptr<BaseOption> option);
             void Clear();
             void BootStrap();
+            /** Draw all options again, keeping the selection */
+            void ReDraw();
             void SelectNext();
             void SelectPrevious();
             void Toggle();
+            void Increase();
+            void Decrease();
 
         private:
             class SelectedOption
@@ -187,6 +240,7 @@ namespace Snake
 
         Console& _console;
         Menu _menu;
+        SettingsService& _settingsService;
         bool _active{false};
         bool _closed{false};
         Settings _settings{};
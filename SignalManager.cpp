@@ -7,6 +7,9 @@
 using namespace Snake;
 
 std::shared_ptr<SignalManager> SignalManager::_singleton{nullptr};
+std::atomic<uint64_t> SignalManager::_pending{0};
+/** Touched from the signal handler */
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
 
 std::shared_ptr<SignalManager> SignalManager::GetSingleton(Tev& tev)
 {
@@ -32,11 +35,19 @@ SignalManager::SignalManager(Tev& tev)
         {
             throw std::runtime_error("eventfd_read failed");
         }
-        int signum = static_cast<int>(value);
-        auto pair = _handlers.find(signum);
-        if (pair != _handlers.end())
+        /** The counter adds up, so it cannot tell which signals arrived */
+        uint64_t pending = _pending.exchange(0);
+        for (int signum = 0; signum < 64; signum++)
         {
-            pair->second();
+            if ((pending & (uint64_t{1} << signum)) == 0)
+            {
+                continue;
+            }
+            auto pair = _handlers.find(signum);
+            if (pair != _handlers.end())
+            {
+                pair->second();
+            }
         }
     });
 }
@@ -70,6 +81,10 @@ void SignalManager::Close()
 
 void SignalManager::SetHandler(int signum, const std::function<void()>& handler)
 {
+    if (signum <= 0 || signum >= 64)
+    {
+        throw std::invalid_argument("Invalid signal number");
+    }
     if (handler == nullptr)
     {
         _handlers.erase(signum);
@@ -86,8 +101,8 @@ void SignalManager::SetHandler(int signum, const std::function<void()>& handler)
             auto singleton = SignalManager::_singleton;
             if (singleton != nullptr)
             {
-                eventfd_t value = static_cast<eventfd_t>(signum);
-                eventfd_write(singleton->_eventFd, value);
+                _pending.fetch_or(uint64_t{1} << signum);
+                eventfd_write(singleton->_eventFd, 1);
             }
         };
         sigemptyset(&sa.sa_mask);
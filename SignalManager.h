@@ -4,6 +4,8 @@
 #include <functional>
 #include <unordered_map>
 #include <memory>
+#include <atomic>
+#include <stdint.h>
 
 namespace Snake
 {
@@ -19,10 +21,19 @@ namespace Snake
         SignalManager& operator=(SignalManager&& other) noexcept = delete;
 
         void Close();
+        /**
+         * @brief Run a handler on the event loop when a signal arrives.
+         *      Signals arriving before the loop gets to them are handled once.
+         * 
+         * @param signum Below 64.
+         * @param handler nullptr to restore the default action.
+         */
         void SetHandler(int signum, const std::function<void()>& handler);
 
     private:
         static std::shared_ptr<SignalManager> _singleton;    
+        /** One bit per signal, the eventfd only wakes the loop up */
+        static std::atomic<uint64_t> _pending;
 
         Tev& _tev;
         int _eventFd = -1;
@@ -0,0 +1,238 @@
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "SnakeCore.h"
+#include "GameEngine.h"
+
+using Snake::GameEngine;
+using Snake::Level;
+
+struct snake_game
+{
+    GameEngine engine;
+    /** The engine keeps a bitboard, this is the byte per cell view of snake_cells */
+    std::vector<uint8_t> cells{};
+};
+
+namespace
+{
+    thread_local std::string lastError{};
+
+    /** Nothing may be thrown through the C API, a failure becomes the fallback value */
+    template <typename F, typename T>
+    T Guard(F function, T fallback)
+    {
+        try
+        {
+            return function();
+        }
+        catch (const std::exception& e)
+        {
+            lastError = e.what();
+        }
+        catch (...)
+        {
+            lastError = "Unknown error";
+        }
+        return fallback;
+    }
+
+    static_assert(static_cast<int>(GameEngine::Direction::Up) == SNAKE_UP);
+    static_assert(static_cast<int>(GameEngine::Direction::Right) == SNAKE_RIGHT);
+    static_assert(static_cast<int>(GameEngine::CellType::Food) == SNAKE_CELL_FOOD);
+    static_assert(static_cast<int>(GameEngine::CellType::Wall) == SNAKE_CELL_WALL);
+    static_assert(static_cast<int>(GameEngine::Outcome::Won) == SNAKE_WON);
+    static_assert(GameEngine::TickDelta::NO_CELL == SNAKE_NO_CELL);
+    static_assert(sizeof(GameEngine::CellType) == sizeof(uint8_t));
+
+    void FillCells(snake_game* game)
+    {
+        const auto& engine = game->engine;
+        game->cells.assign(static_cast<size_t>(engine.GetWidth()) * engine.GetHeight(), SNAKE_CELL_EMPTY);
+        game->cells[engine.ToIndex(engine.GetFood())] = SNAKE_CELL_FOOD;
+        engine.GetLevel()->ForEachWall([game](uint32_t wall){
+            game->cells[wall] = SNAKE_CELL_WALL;
+        });
+        for (const auto& segment : engine.GetSnake())
+        {
+            game->cells[engine.ToIndex(segment)] = static_cast<uint8_t>(engine.GetCell(segment));
+        }
+    }
+
+    /** Write what a step changed, without asking the engine for each cell */
+    void UpdateCells(snake_game* game, const GameEngine::TickDelta& delta)
+    {
+        if (delta.outcome == GameEngine::Outcome::Dead)
+        {
+            return;
+        }
+        auto& cells = game->cells;
+        if (delta.tail != GameEngine::TickDelta::NO_CELL)
+        {
+            cells[delta.tail] = SNAKE_CELL_EMPTY;
+        }
+        cells[delta.head] = static_cast<uint8_t>(GameEngine::SnakeCellType(game->engine.GetDirection()));
+        if (delta.food != GameEngine::TickDelta::NO_CELL)
+        {
+            cells[delta.food] = SNAKE_CELL_FOOD;
+        }
+    }
+}
+
+int snake_api_version(void)
+{
+    return SNAKE_API_VERSION;
+}
+
+const char* snake_last_error(void)
+{
+    return lastError.c_str();
+}
+
+snake_game* snake_create(int width, int height, uint64_t seed)
+{
+    return Guard([&](){
+        std::unique_ptr<snake_game> game{new snake_game{GameEngine{width, height}}};
+        game->engine.Reset(seed);
+        FillCells(game.get());
+        return game.release();
+    }, static_cast<snake_game*>(nullptr));
+}
+
+snake_game* snake_create_level(const char* level, size_t size, uint64_t seed)
+{
+    return Guard([&](){
+        std::istringstream input{std::string{level, size}};
+        std::unique_ptr<snake_game> game{new snake_game{GameEngine{Level::Parse(input, "")}}};
+        game->engine.Reset(seed);
+        FillCells(game.get());
+        return game.release();
+    }, static_cast<snake_game*>(nullptr));
+}
+
+void snake_destroy(snake_game* game)
+{
+    delete game;
+}
+
+int snake_reset(snake_game* game, uint64_t seed)
+{
+    return Guard([&](){
+        game->engine.Reset(seed);
+        FillCells(game);
+        return 0;
+    }, -1);
+}
+
+int64_t snake_step(snake_game* game, const uint8_t* directions, size_t count, snake_delta* deltas)
+{
+    return Guard([&](){
+        auto& engine = game->engine;
+        if (engine.IsFinished())
+        {
+            throw std::logic_error("Game is finished");
+        }
+        /** All of them before the first step, a failed call leaves the game as it was */
+        for (size_t i = 0; i < count; i++)
+        {
+            if (directions[i] > SNAKE_RIGHT)
+            {
+                throw std::invalid_argument("Invalid direction");
+            }
+        }
+        size_t taken = 0;
+        while (taken < count && !engine.IsFinished())
+        {
+            engine.SetDirection(static_cast<GameEngine::Direction>(directions[taken]));
+            auto delta = engine.Step().delta;
+            UpdateCells(game, delta);
+            if (deltas != nullptr)
+            {
+                deltas[taken] = {
+                    delta.head,
+                    delta.tail,
+                    delta.food,
+                    static_cast<uint8_t>(delta.tailType),
+                    static_cast<uint8_t>(delta.direction),
+                    static_cast<uint8_t>(delta.outcome),
+                    0,
+                };
+            }
+            taken++;
+        }
+        return static_cast<int64_t>(taken);
+    }, int64_t{-1});
+}
+
+int snake_width(const snake_game* game)
+{
+    return game->engine.GetWidth();
+}
+
+int snake_height(const snake_game* game)
+{
+    return game->engine.GetHeight();
+}
+
+const uint8_t* snake_cells(const snake_game* game)
+{
+    return game->cells.data();
+}
+
+size_t snake_body(const snake_game* game, uint32_t* cells, size_t capacity)
+{
+    const auto& snake = game->engine.GetSnake();
+    for (size_t i = 0; i < snake.size() && i < capacity; i++)
+    {
+        cells[i] = game->engine.ToIndex(snake[i]);
+    }
+    return snake.size();
+}
+
+uint32_t snake_food(const snake_game* game)
+{
+    return game->engine.ToIndex(game->engine.GetFood());
+}
+
+int snake_score(const snake_game* game)
+{
+    return game->engine.GetScore();
+}
+
+uint32_t snake_tick(const snake_game* game)
+{
+    return game->engine.GetTick();
+}
+
+int snake_is_finished(const snake_game* game)
+{
+    return game->engine.IsFinished() ? 1 : 0;
+}
+
+int64_t snake_serialize(const snake_game* game, uint8_t* buffer, size_t capacity)
+{
+    return Guard([&](){
+        std::ostringstream output{};
+        game->engine.Serialize(output);
+        auto state = output.str();
+        if (buffer != nullptr && capacity >= state.size())
+        {
+            std::memcpy(buffer, state.data(), state.size());
+        }
+        return static_cast<int64_t>(state.size());
+    }, int64_t{-1});
+}
+
+int snake_deserialize(snake_game* game, const uint8_t* buffer, size_t size)
+{
+    return Guard([&](){
+        std::istringstream input{std::string{reinterpret_cast<const char*>(buffer), size}};
+        game->engine.Deserialize(input);
+        FillCells(game);
+        return 0;
+    }, -1);
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+/**
+ * @brief The game engine behind a C API, for tools that drive it through FFI.
+ *      Only the engine is in the library, nothing of the terminal or the settings.
+ *      Functions do not throw. Those that can fail return a negative value or NULL
+ *      and leave a message for snake_last_error.
+ *      A game may be used from one thread at a time.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define SNAKE_API __attribute__((visibility("default")))
+#else
+#define SNAKE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Raised when a change breaks callers built against an older version */
+#define SNAKE_API_VERSION 1
+
+typedef struct snake_game snake_game;
+
+/** The values of GameEngine::Direction */
+enum snake_direction
+{
+    SNAKE_UP = 0,
+    SNAKE_DOWN = 1,
+    SNAKE_LEFT = 2,
+    SNAKE_RIGHT = 3,
+};
+
+/** The values of GameEngine::CellType */
+enum snake_cell
+{
+    SNAKE_CELL_EMPTY = 0,
+    SNAKE_CELL_SNAKE_RIGHT = 1,
+    SNAKE_CELL_SNAKE_LEFT = 2,
+    SNAKE_CELL_SNAKE_UP = 3,
+    SNAKE_CELL_SNAKE_DOWN = 4,
+    SNAKE_CELL_FOOD = 5,
+    SNAKE_CELL_WALL = 6,
+};
+
+/** The values of GameEngine::Outcome */
+enum snake_outcome
+{
+    SNAKE_MOVED = 0,
+    SNAKE_ATE = 1,
+    SNAKE_DEAD = 2,
+    SNAKE_WON = 3,
+};
+
+/** The cells one step changed, as GameEngine::TickDelta */
+typedef struct snake_delta
+{
+    /** The new head, as x + y*width */
+    uint32_t head;
+    /** The freed tail cell, SNAKE_NO_CELL if the snake grew */
+    uint32_t tail;
+    /** The new food, SNAKE_NO_CELL if none was placed */
+    uint32_t food;
+    /** The snake_cell the freed tail had */
+    uint8_t tail_type;
+    /** The snake_direction before the step */
+    uint8_t direction;
+    /** A snake_outcome */
+    uint8_t outcome;
+    uint8_t reserved;
+} snake_delta;
+
+#define SNAKE_NO_CELL UINT32_MAX
+
+SNAKE_API int snake_api_version(void);
+/** The reason the last failing call on this thread failed */
+SNAKE_API const char* snake_last_error(void);
+
+/**
+ * @brief Start a game.
+ *
+ * @param width At least 10, at most 4096.
+ * @param height At least 1, at most 4096.
+ * @param seed Decides where the food shows up.
+ * @return NULL if the size is invalid.
+ */
+SNAKE_API snake_game* snake_create(int width, int height, uint64_t seed);
+/**
+ * @brief Start a game on a level, in the text form of Level.h:
+ *      a row per line, '#' for a wall and '.' for a free cell, "edges solid" for deadly edges,
+ *      '^', 'v', '<' or '>' for where the snake can start.
+ *
+ * @param level Not null terminated.
+ * @param size Bytes of level.
+ * @param seed Decides where the food shows up, and which spawn the snake starts at.
+ * @return NULL if the level is invalid.
+ */
+SNAKE_API snake_game* snake_create_level(const char* level, size_t size, uint64_t seed);
+SNAKE_API void snake_destroy(snake_game* game);
+/** Start the game again, 0 or -1 */
+SNAKE_API int snake_reset(snake_game* game, uint64_t seed);
+
+/**
+ * @brief Take several steps in one call.
+ *      Stops after a step that ends the game.
+ *
+ * @param directions One snake_direction per step. Turning back keeps the direction.
+ * @param count Steps to take.
+ * @param deltas NULL, or room for count deltas.
+ * @return The steps taken. -1 if any direction is invalid or the game is already over,
+ *      then no step is taken.
+ */
+SNAKE_API int64_t snake_step(snake_game* game, const uint8_t* directions, size_t count, snake_delta* deltas);
+
+SNAKE_API int snake_width(const snake_game* game);
+SNAKE_API int snake_height(const snake_game* game);
+/**
+ * @brief The board, one snake_cell per cell, row after row.
+ *      Not a copy, it changes with the game and is valid until the game is reset, restored or destroyed.
+ */
+SNAKE_API const uint8_t* snake_cells(const snake_game* game);
+/** The cells of the snake, head first, as x + y*width. Returns the length, writes up to capacity. */
+SNAKE_API size_t snake_body(const snake_game* game, uint32_t* cells, size_t capacity);
+SNAKE_API uint32_t snake_food(const snake_game* game);
+SNAKE_API int snake_score(const snake_game* game);
+SNAKE_API uint32_t snake_tick(const snake_game* game);
+SNAKE_API int snake_is_finished(const snake_game* game);
+
+/**
+ * @brief Write the state of an unfinished game.
+ *
+ * @param buffer NULL to ask for the size.
+ * @return The size of the state, nothing is written if capacity is smaller. -1 if the game is over.
+ */
+SNAKE_API int64_t snake_serialize(const snake_game* game, uint8_t* buffer, size_t capacity);
+/**
+ * @brief Restore a state written by snake_serialize, with the board size, edges and walls it has.
+ *
+ * @return 0, or -1 if the state is invalid and the game was left as it was.
+ */
+SNAKE_API int snake_deserialize(snake_game* game, const uint8_t* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,78 @@
+/**
+ * @brief Steps per second through the C API of libsnakecore,
+ *      with several batch sizes to show what one call costs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "SnakeCore.h"
+
+#define WIDTH 39
+#define HEIGHT 22
+#define STEPS (1u << 24)
+/** Going straight never crashes a short snake, a turn in 8 steps keeps it moving about */
+#define TURN_ODDS 8
+
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/** Run STEPS steps in calls of batch steps, returns steps per second */
+static double Run(snake_game* game, const uint8_t* directions, snake_delta* deltas, size_t batch)
+{
+    uint64_t seed = 0;
+    size_t done = 0;
+    double start = Now();
+    snake_reset(game, seed);
+    while (done < STEPS)
+    {
+        int64_t taken = snake_step(game, directions + done % (STEPS - batch), batch, deltas);
+        if (taken < 0)
+        {
+            fprintf(stderr, "snake_step: %s\n", snake_last_error());
+            exit(1);
+        }
+        done += (size_t)taken;
+        if (snake_is_finished(game))
+        {
+            snake_reset(game, ++seed);
+        }
+    }
+    return (double)done / (Now() - start);
+}
+
+int main(void)
+{
+    static const size_t BATCHES[] = {1, 16, 256, 4096};
+    if (snake_api_version() != SNAKE_API_VERSION)
+    {
+        fprintf(stderr, "libsnakecore has API version %d, built against %d\n", snake_api_version(), SNAKE_API_VERSION);
+        return 1;
+    }
+    snake_game* game = snake_create(WIDTH, HEIGHT, 0);
+    uint8_t* directions = malloc(STEPS);
+    snake_delta* deltas = malloc(sizeof(snake_delta) * BATCHES[sizeof(BATCHES)/sizeof(BATCHES[0]) - 1]);
+    if (game == NULL || directions == NULL || deltas == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    srand(0);
+    for (size_t i = 0; i < STEPS; i++)
+    {
+        directions[i] = rand() % TURN_ODDS == 0 ? (uint8_t)(rand() % 4) : SNAKE_RIGHT;
+    }
+    printf("libsnakecore, %dx%d board, %u steps\n", WIDTH, HEIGHT, STEPS);
+    for (size_t i = 0; i < sizeof(BATCHES)/sizeof(BATCHES[0]); i++)
+    {
+        printf("  %4zu steps per call: %6.1f M steps/s\n", BATCHES[i], Run(game, directions, deltas, BATCHES[i]) / 1e6);
+    }
+    free(deltas);
+    free(directions);
+    snake_destroy(game);
+    return 0;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stddef.h>
+#include <array>
+#include <atomic>
+#include <utility>
+
+namespace Snake
+{
+    /**
+     * @brief A fixed size queue from one producer thread to one consumer thread, without locks.
+     *      Each side only writes its own index and keeps a copy of the other one,
+     *      so the shared indices are only read when the queue looks full or empty.
+     *
+     * @tparam T Moved in and out, the slots keep what is left of it.
+     * @tparam N Capacity, a power of two.
+     */
+    template <typename T, size_t N>
+    class SpscRing
+    {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        SpscRing() = default;
+        ~SpscRing() = default;
+
+        SpscRing(const SpscRing& other) = delete;
+        SpscRing& operator=(const SpscRing& other) = delete;
+        SpscRing(SpscRing&& other) noexcept = delete;
+        SpscRing& operator=(SpscRing&& other) noexcept = delete;
+
+        /**
+         * @brief Producer side.
+         *
+         * @return false if the queue is full, the value is left as it was.
+         */
+        bool TryPush(T&& value)
+        {
+            auto tail = _tail.load(std::memory_order_relaxed);
+            if (tail - _headCopy == N)
+            {
+                _headCopy = _head.load(std::memory_order_acquire);
+                if (tail - _headCopy == N)
+                {
+                    return false;
+                }
+            }
+            _slots[tail & (N - 1)] = std::move(value);
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Consumer side.
+         *
+         * @return false if the queue is empty.
+         */
+        bool TryPop(T& value)
+        {
+            auto head = _head.load(std::memory_order_relaxed);
+            if (head == _tailCopy)
+            {
+                _tailCopy = _tail.load(std::memory_order_acquire);
+                if (head == _tailCopy)
+                {
+                    return false;
+                }
+            }
+            value = std::move(_slots[head & (N - 1)]);
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        /** The two sides keep to their own cache lines */
+        static constexpr size_t CACHE_LINE = 64;
+
+        /** Consumer side */
+        alignas(CACHE_LINE) std::atomic<size_t> _head{0};
+        size_t _tailCopy{0};
+        /** Producer side */
+        alignas(CACHE_LINE) std::atomic<size_t> _tail{0};
+        size_t _headCopy{0};
+        alignas(CACHE_LINE) std::array<T, N> _slots{};
+    };
+}
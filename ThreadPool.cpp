@@ -0,0 +1,132 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+using namespace Snake;
+
+namespace
+{
+    /** The pool and queue of the current thread, if it is a pool thread */
+    thread_local const void* currentPool = nullptr;
+    thread_local size_t currentQueue = 0;
+}
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _queues.reserve(threads);
+    for (size_t i = 0; i < threads; i++)
+    {
+        _queues.emplace_back(std::make_unique<Queue>());
+    }
+    _threads.reserve(threads);
+    for (size_t i = 0; i < threads; i++)
+    {
+        _threads.emplace_back(&ThreadPool::Worker, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock{_mutex};
+        _stopping = true;
+    }
+    _jobAvailable.notify_all();
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+    size_t index = currentPool == this
+        ? currentQueue
+        : _nextQueue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+    _unfinished.fetch_add(1);
+    {
+        /** Counted first, a thread that wakes up early looks again until it finds the job */
+        std::lock_guard lock{_mutex};
+        _queued.fetch_add(1);
+    }
+    {
+        auto& queue = *_queues[index];
+        std::lock_guard lock{queue.mutex};
+        queue.jobs.emplace_back(std::move(job));
+    }
+    _jobAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock lock{_mutex};
+    _jobsDone.wait(lock, [this](){
+        return _unfinished.load() == 0;
+    });
+}
+
+size_t ThreadPool::GetThreadCount() const
+{
+    return _threads.size();
+}
+
+void ThreadPool::Worker(size_t index)
+{
+    currentPool = this;
+    currentQueue = index;
+    while (true)
+    {
+        auto job = TakeJob(index);
+        if (job)
+        {
+            job();
+            if (_unfinished.fetch_sub(1) == 1)
+            {
+                std::lock_guard lock{_mutex};
+                _jobsDone.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock lock{_mutex};
+        _jobAvailable.wait(lock, [this](){
+            return _stopping || _queued.load() != 0;
+        });
+        if (_queued.load() == 0)
+        {
+            /** Stopping */
+            return;
+        }
+    }
+}
+
+std::function<void()> ThreadPool::TakeJob(size_t index)
+{
+    std::function<void()> job{};
+    {
+        auto& own = *_queues[index];
+        std::lock_guard lock{own.mutex};
+        if (!own.jobs.empty())
+        {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+        }
+    }
+    for (size_t i = 1; !job && i < _queues.size(); i++)
+    {
+        auto& other = *_queues[(index + i) % _queues.size()];
+        std::lock_guard lock{other.mutex};
+        if (!other.jobs.empty())
+        {
+            job = std::move(other.jobs.front());
+            other.jobs.pop_front();
+        }
+    }
+    if (job)
+    {
+        _queued.fetch_sub(1);
+    }
+    return job;
+}
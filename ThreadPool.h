@@ -0,0 +1,74 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace Snake
+{
+    /**
+     * @brief Runs jobs on a fixed set of threads.
+     *      Each thread has its own queue and takes its newest job first.
+     *      A thread with nothing to do steals the oldest job of another one,
+     *      so threads only contend when one of them runs dry.
+     */
+    class ThreadPool
+    {
+    public:
+        /**
+         * @brief Construct a new Thread Pool.
+         * 
+         * @param threads 0 to use one thread per core.
+         */
+        explicit ThreadPool(size_t threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+        ThreadPool(ThreadPool&& other) noexcept = delete;
+        ThreadPool& operator=(ThreadPool&& other) noexcept = delete;
+
+        /**
+         * @brief Run a job on one of the threads.
+         *      Jobs must not throw. A job submitted from a job goes to the same thread.
+         * 
+         * @param job 
+         */
+        void Submit(std::function<void()> job);
+        /**
+         * @brief Block until all submitted jobs are done.
+         */
+        void Wait();
+        size_t GetThreadCount() const;
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex{};
+            std::deque<std::function<void()>> jobs{};
+        };
+
+        std::vector<std::thread> _threads{};
+        std::vector<std::unique_ptr<Queue>> _queues{};
+        /** Where the next job from outside the pool goes */
+        std::atomic<size_t> _nextQueue{0};
+        /** Jobs in the queues */
+        std::atomic<size_t> _queued{0};
+        /** Jobs submitted and not done */
+        std::atomic<size_t> _unfinished{0};
+        /** Only for sleeping and waking up */
+        std::mutex _mutex{};
+        std::condition_variable _jobAvailable{};
+        std::condition_variable _jobsDone{};
+        bool _stopping{false};
+
+        void Worker(size_t index);
+        /** The newest job of the own queue, or the oldest one of another queue */
+        std::function<void()> TakeJob(size_t index);
+    };
+}
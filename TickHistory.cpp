@@ -0,0 +1,50 @@
+#include "TickHistory.h"
+
+using namespace Snake;
+
+void TickHistory::Reset(size_t capacity)
+{
+    _deltas.assign(capacity, GameEngine::TickDelta{});
+    _next = 0;
+    _size = 0;
+}
+
+void TickHistory::Push(const GameEngine::TickDelta& delta)
+{
+    if (_deltas.empty())
+    {
+        return;
+    }
+    _deltas[_next] = delta;
+    _next = (_next + 1) % _deltas.size();
+    if (_size < _deltas.size())
+    {
+        _size++;
+    }
+}
+
+std::optional<GameEngine::TickDelta> TickHistory::Pop()
+{
+    if (_size == 0)
+    {
+        return std::nullopt;
+    }
+    _next = (_next + _deltas.size() - 1) % _deltas.size();
+    _size--;
+    return _deltas[_next];
+}
+
+size_t TickHistory::Size() const
+{
+    return _size;
+}
+
+bool TickHistory::Empty() const
+{
+    return _size == 0;
+}
+
+size_t TickHistory::GetCapacity() const
+{
+    return _deltas.size();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include "GameEngine.h"
+
+namespace Snake
+{
+    /**
+     * @brief The last steps of a game, oldest dropped first.
+     *      Only deltas are kept, so the size does not depend on the board.
+     */
+    class TickHistory
+    {
+    public:
+        TickHistory() = default;
+        ~TickHistory() = default;
+
+        /**
+         * @brief Forget everything and keep up to capacity steps from now on.
+         * 
+         * @param capacity 
+         */
+        void Reset(size_t capacity);
+        void Push(const GameEngine::TickDelta& delta);
+        /**
+         * @brief Take the newest step out.
+         * 
+         * @return nothing if the history is empty.
+         */
+        std::optional<GameEngine::TickDelta> Pop();
+        size_t Size() const;
+        size_t GetCapacity() const;
+        bool Empty() const;
+
+    private:
+        std::vector<GameEngine::TickDelta> _deltas{};
+        /** Where the next delta goes */
+        size_t _next{0};
+        size_t _size{0};
+    };
+}
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Tournament.h"
+#include "Autopilot.h"
+#include "GameEngine.h"
+#include "ThreadPool.h"
+
+using namespace Snake;
+
+namespace
+{
+    /** A game without food for this many board sizes of ticks is going in circles */
+    constexpr uint32_t STALL_BOARDS = 2;
+
+    enum class Ending : uint8_t
+    {
+        Died,
+        Won,
+        Stalled,
+    };
+
+    std::string_view GetEndingName(Ending ending)
+    {
+        switch (ending)
+        {
+        case Ending::Died:
+            return "died";
+        case Ending::Won:
+            return "won";
+        case Ending::Stalled:
+            return "stalled";
+        default:
+            throw std::invalid_argument("Invalid ending");
+        }
+    }
+
+    /**
+     * @brief Tick durations in buckets, four to every power of two,
+     *      so games can be added up without keeping every tick.
+     */
+    class TickTimes
+    {
+    public:
+        void Add(uint64_t nanoseconds)
+        {
+            _buckets[ToBucket(nanoseconds)]++;
+            _count++;
+            _max = std::max(_max, nanoseconds);
+        }
+
+        void Add(const TickTimes& other)
+        {
+            for (size_t i = 0; i < BUCKETS; i++)
+            {
+                _buckets[i] += other._buckets[i];
+            }
+            _count += other._count;
+            _max = std::max(_max, other._max);
+        }
+
+        /** The lower end of the bucket the quantile falls in */
+        uint64_t GetQuantile(double quantile) const
+        {
+            auto rank = static_cast<uint64_t>(quantile * static_cast<double>(_count));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKETS; i++)
+            {
+                seen += _buckets[i];
+                if (seen > rank)
+                {
+                    return FromBucket(i);
+                }
+            }
+            return _max;
+        }
+
+        uint64_t GetMax() const
+        {
+            return _max;
+        }
+
+    private:
+        static constexpr size_t BUCKETS = 160;
+
+        std::array<uint64_t, BUCKETS> _buckets{};
+        uint64_t _count{0};
+        uint64_t _max{0};
+
+        static size_t ToBucket(uint64_t value)
+        {
+            if (value < 4)
+            {
+                return static_cast<size_t>(value);
+            }
+            size_t exponent = std::bit_width(value) - 1;
+            size_t bucket = (exponent - 1)*4 + ((value >> (exponent - 2)) & 3);
+            return std::min(bucket, BUCKETS - 1);
+        }
+
+        static uint64_t FromBucket(size_t bucket)
+        {
+            if (bucket < 4)
+            {
+                return bucket;
+            }
+            return (4 + bucket % 4) << (bucket/4 - 1);
+        }
+    };
+
+    struct GameRecord
+    {
+        Ending ending{Ending::Died};
+        int score{0};
+        size_t length{0};
+        uint32_t ticks{0};
+        std::chrono::nanoseconds time{0};
+        TickTimes tickTimes{};
+    };
+
+    GameRecord PlayGame(Autopilot::Strategy strategy, uint64_t seed, int width, int height)
+    {
+        GameEngine engine{width, height};
+        engine.Reset(seed);
+        auto autopilot = Autopilot::Create(strategy);
+        autopilot->Reset(engine);
+        uint32_t stallTicks = STALL_BOARDS * static_cast<uint32_t>(width * height);
+        uint32_t sinceFood = 0;
+        GameRecord record{};
+        while (true)
+        {
+            auto start = std::chrono::steady_clock::now();
+            engine.SetDirection(autopilot->Plan(engine));
+            auto result = engine.Step();
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            record.time += elapsed;
+            record.tickTimes.Add(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            if (result.outcome == GameEngine::Outcome::Dead)
+            {
+                record.ending = Ending::Died;
+                break;
+            }
+            if (result.outcome == GameEngine::Outcome::Won)
+            {
+                record.ending = Ending::Won;
+                break;
+            }
+            sinceFood = result.outcome == GameEngine::Outcome::Ate ? 0 : sinceFood + 1;
+            if (sinceFood >= stallTicks)
+            {
+                record.ending = Ending::Stalled;
+                break;
+            }
+        }
+        record.score = engine.GetScore();
+        record.length = engine.GetSnake().size();
+        record.ticks = engine.GetTick();
+        return record;
+    }
+
+    /** Median, 90th percentile and maximum of a column */
+    template <typename T>
+    std::string Summarize(std::vector<T> values)
+    {
+        if (values.empty())
+        {
+            return "-";
+        }
+        std::sort(values.begin(), values.end());
+        auto at = [&values](double quantile){
+            return std::to_string(values[static_cast<size_t>(quantile * static_cast<double>(values.size() - 1))]);
+        };
+        return at(0.5) + "/" + at(0.9) + "/" + std::to_string(values.back());
+    }
+}
+
+void Tournament::Run(const Options& options, std::ostream& output)
+{
+    constexpr size_t STRATEGY_COUNT = std::size(Autopilot::STRATEGIES);
+    /** Fails early on a bad size, not on every thread */
+    GameEngine{options.boardWidth, options.boardHeight};
+    std::ofstream csv{options.csvPath};
+    if (!csv)
+    {
+        throw std::runtime_error("Cannot write " + options.csvPath.string());
+    }
+
+    /** One slot per game, so the workers never share anything */
+    std::vector<GameRecord> records(STRATEGY_COUNT * options.games);
+    size_t threads = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool{options.threads};
+        threads = pool.GetThreadCount();
+        /** Game by game rather than strategy by strategy, so slow strategies are spread out */
+        for (uint32_t game = 0; game < options.games; game++)
+        {
+            for (size_t s = 0; s < STRATEGY_COUNT; s++)
+            {
+                auto& record = records[s*options.games + game];
+                auto strategy = Autopilot::STRATEGIES[s];
+                auto seed = options.seed + game;
+                pool.Submit([&record, &options, strategy, seed](){
+                    record = PlayGame(strategy, seed, options.boardWidth, options.boardHeight);
+                });
+            }
+        }
+        pool.Wait();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    csv << "strategy,game,seed,ending,score,length,ticks,mean_tick_ns,max_tick_ns\n";
+    uint64_t totalTicks = 0;
+    output << "Tournament: " << options.games << " games per strategy, "
+        << options.boardWidth << "x" << options.boardHeight << " board, " << threads << " threads" << std::endl;
+    output << std::left << std::setw(16) << "strategy"
+        << std::right << std::setw(6) << "won" << std::setw(6) << "died" << std::setw(8) << "stalled"
+        << "  " << std::left << std::setw(20) << "score p50/p90/max"
+        << std::setw(20) << "length p50/p90/max"
+        << std::setw(22) << "ticks p50/p90/max"
+        << "tick ns p50/p99/p99.9/max" << std::endl;
+    for (size_t s = 0; s < STRATEGY_COUNT; s++)
+    {
+        auto strategy = Autopilot::STRATEGIES[s];
+        std::array<uint32_t, 3> endings{};
+        std::vector<int> scores{};
+        std::vector<size_t> lengths{};
+        std::vector<uint32_t> ticks{};
+        TickTimes tickTimes{};
+        for (uint32_t game = 0; game < options.games; game++)
+        {
+            const auto& record = records[s*options.games + game];
+            endings[static_cast<size_t>(record.ending)]++;
+            scores.push_back(record.score);
+            lengths.push_back(record.length);
+            ticks.push_back(record.ticks);
+            tickTimes.Add(record.tickTimes);
+            totalTicks += record.ticks;
+            csv << Autopilot::GetKey(strategy) << "," << game << "," << options.seed + game << ","
+                << GetEndingName(record.ending) << "," << record.score << "," << record.length << ","
+                << record.ticks << ","
+                << (record.ticks == 0 ? 0 : record.time.count() / record.ticks) << ","
+                << record.tickTimes.GetMax() << "\n";
+        }
+        output << std::left << std::setw(16) << Autopilot::GetName(strategy)
+            << std::right << std::setw(6) << endings[static_cast<size_t>(Ending::Won)]
+            << std::setw(6) << endings[static_cast<size_t>(Ending::Died)]
+            << std::setw(8) << endings[static_cast<size_t>(Ending::Stalled)]
+            << "  " << std::left << std::setw(20) << Summarize(scores)
+            << std::setw(20) << Summarize(lengths)
+            << std::setw(22) << Summarize(ticks)
+            << tickTimes.GetQuantile(0.5) << "/" << tickTimes.GetQuantile(0.99) << "/"
+            << tickTimes.GetQuantile(0.999) << "/" << tickTimes.GetMax() << std::endl;
+    }
+    output << std::right;
+    csv.close();
+    if (!csv)
+    {
+        throw std::runtime_error("Cannot write " + options.csvPath.string());
+    }
+    auto games = static_cast<double>(records.size());
+    output << std::fixed << std::setprecision(1)
+        << records.size() << " games, " << totalTicks << " ticks in " << elapsed << " s: "
+        << games / elapsed << " games/s, " << static_cast<double>(totalTicks) / elapsed << " ticks/s" << std::endl;
+    output << "Per game results in " << options.csvPath.string() << std::endl;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include <filesystem>
+#include <ostream>
+
+namespace Snake
+{
+    /**
+     * @brief Headless autopilot games on all cores, every strategy on the same seeds.
+     *      Writes a summary table and one CSV line per game.
+     */
+    class Tournament
+    {
+    public:
+        struct Options
+        {
+            /** Games per strategy */
+            uint32_t games{1000};
+            int boardWidth{39};
+            int boardHeight{22};
+            /** 0 to use one thread per core */
+            size_t threads{0};
+            /** Game i of every strategy is seeded with seed + i */
+            uint64_t seed{1};
+            std::filesystem::path csvPath{"tournament.csv"};
+        };
+
+        /**
+         * @brief Play the games and report on them.
+         *
+         * @param options
+         * @param output Gets the summary table.
+         */
+        static void Run(const Options& options, std::ostream& output);
+    };
+}
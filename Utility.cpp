@@ -1,10 +1,56 @@
 #include "Utility.h"
 #include <pwd.h>
 #include <unistd.h>
+#include <string_view>
+#include <vector>
 #include "Constants.h"
 
 using namespace Snake;
 
+namespace
+{
+    /** Left, then middle repeated, then right. Each length is built once, borders only depend on it */
+    class BorderStyle
+    {
+    public:
+        BorderStyle(std::string_view left, std::string_view middle, std::string_view right)
+            : _left(left), _middle(middle), _right(right)
+        {
+        }
+
+        const std::string& Get(size_t count)
+        {
+            if (count >= _borders.size())
+            {
+                _borders.resize(count + 1);
+            }
+            auto& border = _borders[count];
+            if (border.empty())
+            {
+                border.reserve(_left.size() + _middle.size()*count + _right.size());
+                border += _left;
+                for (size_t i = 0; i < count; i++)
+                {
+                    border += _middle;
+                }
+                border += _right;
+            }
+            return border;
+        }
+
+    private:
+        std::string_view _left;
+        std::string_view _middle;
+        std::string_view _right;
+        /** Indexed by the count of middle parts */
+        std::vector<std::string> _borders{};
+    };
+
+    BorderStyle topBorder{"┏", "━", "┓"};
+    BorderStyle bottomBorder{"┗", "━", "┛"};
+    BorderStyle lineBorder{"", "━", ""};
+}
+
 std::filesystem::path Utility::_saveFileRoot{};
 
 std::filesystem::path Utility::GetSaveFileRoot()
@@ -37,30 +83,18 @@ void Utility::DrawBox(
     {
         throw std::invalid_argument("Invalid box size");
     }
-    if (x_end >= Constants::DISPLAY_WIDTH ||
-        y_end >= Constants::DISPLAY_HEIGHT)
+    if (x_end >= console.GetWidth() ||
+        y_end >= console.GetHeight())
     {
         throw std::out_of_range("Box coordinates out of range");
     }
-    std::string border = "┏";
-    for (size_t x = x_start + 1; x <= x_end - 1; x++)
-    {
-        border += "━";
-    }
-    border += "┓";
-    console.PutString(x_start, y_start, border);
+    console.PutString(x_start, y_start, topBorder.Get(x_end - x_start - 1));
     for (size_t y = y_start + 1; y <= y_end - 1; y++)
     {
         console.PutString(x_start, y, "┃");
         console.PutString(x_end, y, "┃");
     }
-    border = "┗";
-    for (size_t x = x_start + 1; x <= x_end - 1; x++)
-    {
-        border += "━";
-    }
-    border += "┛";
-    console.PutString(x_start, y_end, border);
+    console.PutString(x_start, y_end, bottomBorder.Get(x_end - x_start - 1));
 }
 
 void Utility::DrawHorizontalLine(
@@ -73,11 +107,16 @@ void Utility::DrawHorizontalLine(
     {
         throw std::invalid_argument("Invalid line size");
     }
-    if (x_end >= Constants::DISPLAY_WIDTH ||
-        y_start >= Constants::DISPLAY_HEIGHT)
+    if (x_end >= console.GetWidth() ||
+        y_start >= console.GetHeight())
     {
         throw std::out_of_range("Line coordinates out of range");
     }
+    if (character == "━")
+    {
+        console.PutString(x_start, y_start, lineBorder.Get(x_end - x_start));
+        return;
+    }
     std::string line{};
     for (size_t x = x_start; x <= x_end - 1; x++)
     {
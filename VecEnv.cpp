@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <stdexcept>
+#include "VecEnv.h"
+
+using namespace Snake;
+
+namespace
+{
+    typedef GameEngine::CellType CellType;
+    typedef GameEngine::Direction Direction;
+
+    constexpr uint8_t EMPTY = static_cast<uint8_t>(CellType::Empty);
+    constexpr uint8_t FOOD = static_cast<uint8_t>(CellType::Food);
+    /** By direction, as GameEngine::SnakeCellType */
+    constexpr uint8_t SNAKE_CELLS[] = {
+        static_cast<uint8_t>(CellType::SnakeUp),
+        static_cast<uint8_t>(CellType::SnakeDown),
+        static_cast<uint8_t>(CellType::SnakeLeft),
+        static_cast<uint8_t>(CellType::SnakeRight),
+    };
+    /** By direction, as GameEngine::OppositeDirection */
+    constexpr uint8_t OPPOSITE[] = {
+        static_cast<uint8_t>(Direction::Down),
+        static_cast<uint8_t>(Direction::Up),
+        static_cast<uint8_t>(Direction::Right),
+        static_cast<uint8_t>(Direction::Left),
+    };
+    constexpr int32_t STEP_X[] = {0, 0, -1, 1};
+    constexpr int32_t STEP_Y[] = {-1, 1, 0, 0};
+}
+
+size_t VecEnv::GetObservationSize(size_t count, int width, int height)
+{
+    return count * static_cast<size_t>(width) * static_cast<size_t>(height);
+}
+
+VecEnv::VecEnv(size_t count, int width, int height, uint64_t seed, std::span<uint8_t> observations)
+    : _count(count),
+      _width(width),
+      _height(height),
+      _size(0),
+      _seed(seed),
+      _cells(observations.data())
+{
+    /** The limits of GameEngine */
+    if (width < GameEngine::MIN_WIDTH || height < 1 || width > GameEngine::MAX_SIZE || height > GameEngine::MAX_SIZE)
+    {
+        throw std::invalid_argument("Invalid board size");
+    }
+    if (count == 0)
+    {
+        throw std::invalid_argument("No games");
+    }
+    if (observations.size() != GetObservationSize(count, width, height))
+    {
+        throw std::invalid_argument("Observation buffer does not fit the games");
+    }
+    _size = static_cast<uint32_t>(width * height);
+    _direction.resize(count);
+    _headX.resize(count);
+    _headY.resize(count);
+    _headSlot.resize(count);
+    _length.resize(count);
+    _score.resize(count);
+    _tick.resize(count);
+    _episode.resize(count, 0);
+    _rng.resize(count);
+    _poolSize.resize(count);
+    _next.resize(count);
+    _body.resize(count * _size);
+    _pool.resize(count * _size);
+    _positions.resize(count * _size);
+    for (size_t game = 0; game < _count; game++)
+    {
+        ResetGame(game);
+    }
+}
+
+void VecEnv::Step(std::span<const Action> actions, std::span<float> rewards, std::span<uint8_t> dones)
+{
+    if (actions.size() != _count || rewards.size() != _count || dones.size() != _count)
+    {
+        throw std::invalid_argument("One action, reward and done per game");
+    }
+    /** Every action before any game moves, so a throw leaves them all as they were */
+    uint8_t invalid = 0;
+    for (auto action : actions)
+    {
+        invalid |= action & ~3;
+    }
+    if (invalid != 0)
+    {
+        throw std::invalid_argument("Invalid action");
+    }
+    /**
+     * Turn and find the next head of every game first.
+     * This pass has no branches that depend on the boards and vectorizes.
+     */
+    for (size_t game = 0; game < _count; game++)
+    {
+        uint8_t action = actions[game];
+        uint8_t direction = action == OPPOSITE[_direction[game]] ? _direction[game] : action;
+        _direction[game] = direction;
+        int32_t x = _headX[game] + STEP_X[direction];
+        int32_t y = _headY[game] + STEP_Y[direction];
+        x = x < 0 ? _width - 1 : (x >= _width ? 0 : x);
+        y = y < 0 ? _height - 1 : (y >= _height ? 0 : y);
+        _headX[game] = x;
+        _headY[game] = y;
+        _next[game] = static_cast<uint32_t>(x + y*_width);
+    }
+    /** Then look at what is there, one game at a time */
+    for (size_t game = 0; game < _count; game++)
+    {
+        uint8_t* cells = _cells + game*_size;
+        uint32_t* body = _body.data() + game*_size;
+        uint32_t next = _next[game];
+        uint8_t cell = cells[next];
+        _tick[game]++;
+        rewards[game] = 0;
+        dones[game] = 0;
+        if (cell == EMPTY)
+        {
+            uint32_t tailSlot = (_headSlot[game] + _size - _length[game] + 1) % _size;
+            uint32_t tail = body[tailSlot];
+            cells[tail] = EMPTY;
+            Insert(game, tail);
+            Remove(game, next);
+        }
+        else if (cell == FOOD)
+        {
+            _score[game]++;
+            _length[game]++;
+            rewards[game] = 1;
+        }
+        else
+        {
+            rewards[game] = -1;
+            dones[game] = 1;
+            ResetGame(game);
+            continue;
+        }
+        _headSlot[game] = _headSlot[game] + 1 == _size ? 0 : _headSlot[game] + 1;
+        body[_headSlot[game]] = next;
+        cells[next] = SNAKE_CELLS[_direction[game]];
+        if (cell == FOOD)
+        {
+            if (_poolSize[game] == 0)
+            {
+                /** Won */
+                dones[game] = 1;
+                ResetGame(game);
+                continue;
+            }
+            cells[PopRandom(game)] = FOOD;
+        }
+    }
+}
+
+void VecEnv::Reset()
+{
+    for (size_t game = 0; game < _count; game++)
+    {
+        ResetGame(game);
+    }
+}
+
+size_t VecEnv::GetCount() const
+{
+    return _count;
+}
+
+int VecEnv::GetWidth() const
+{
+    return _width;
+}
+
+int VecEnv::GetHeight() const
+{
+    return _height;
+}
+
+std::span<const uint32_t> VecEnv::GetScores() const
+{
+    return _score;
+}
+
+std::span<const uint32_t> VecEnv::GetLengths() const
+{
+    return _length;
+}
+
+std::span<const uint32_t> VecEnv::GetTicks() const
+{
+    return _tick;
+}
+
+void VecEnv::ResetGame(size_t game)
+{
+    /** The same steps as GameEngine::Reset, so the pool and the food come out the same */
+    uint8_t* cells = _cells + game*_size;
+    std::fill(cells, cells + _size, EMPTY);
+    std::fill(_positions.begin() + game*_size, _positions.begin() + (game + 1)*_size, NOT_IN_POOL);
+    _poolSize[game] = 0;
+    _rng[game].Seed(_seed + game + static_cast<uint64_t>(_episode[game])*_count);
+    _episode[game]++;
+    for (int x = 0; x < _width; x++)
+    {
+        for (int y = 0; y < _height; y++)
+        {
+            Insert(game, static_cast<uint32_t>(x + y*_width));
+        }
+    }
+    uint32_t* body = _body.data() + game*_size;
+    int y = _height/2;
+    for (uint32_t i = 0; i < START_LENGTH; i++)
+    {
+        uint32_t cell = static_cast<uint32_t>(START_X + static_cast<int>(i) + y*_width);
+        body[i] = cell;
+        cells[cell] = SNAKE_CELLS[static_cast<uint8_t>(Direction::Right)];
+        Remove(game, cell);
+    }
+    _headSlot[game] = START_LENGTH - 1;
+    _length[game] = START_LENGTH;
+    _headX[game] = START_X + START_LENGTH - 1;
+    _headY[game] = y;
+    _direction[game] = static_cast<uint8_t>(Direction::Right);
+    _score[game] = 0;
+    _tick[game] = 0;
+    cells[PopRandom(game)] = FOOD;
+}
+
+void VecEnv::Insert(size_t game, uint32_t cell)
+{
+    uint32_t* positions = _positions.data() + game*_size;
+    if (positions[cell] != NOT_IN_POOL)
+    {
+        return;
+    }
+    positions[cell] = _poolSize[game];
+    _pool[game*_size + _poolSize[game]++] = cell;
+}
+
+void VecEnv::Remove(size_t game, uint32_t cell)
+{
+    uint32_t* positions = _positions.data() + game*_size;
+    uint32_t* pool = _pool.data() + game*_size;
+    uint32_t position = positions[cell];
+    if (position == NOT_IN_POOL)
+    {
+        return;
+    }
+    positions[cell] = NOT_IN_POOL;
+    uint32_t last = pool[--_poolSize[game]];
+    if (position == _poolSize[game])
+    {
+        return;
+    }
+    pool[position] = last;
+    positions[last] = position;
+}
+
+uint32_t VecEnv::PopRandom(size_t game)
+{
+    uint32_t cell = _pool[game*_size + _rng[game].Below(_poolSize[game])];
+    Remove(game, cell);
+    return cell;
+}
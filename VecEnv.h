@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+#include <span>
+#include <vector>
+#include "GameEngine.h"
+#include "Random.h"
+
+namespace Snake
+{
+    /**
+     * @brief Many games of the same size stepped together, for training agents.
+     *      The rules, the start and the food are the same as GameEngine's for the same seed.
+     *      State is kept as one array per field across the games, and the boards are
+     *      the observation buffer of the caller, so a step only writes the cells it changes.
+     *      A game that ends is started again in the same step.
+     */
+    class VecEnv
+    {
+    public:
+        /** Directions as GameEngine::Direction values */
+        typedef uint8_t Action;
+
+        /**
+         * @brief Bytes of observation for a number of games of a size.
+         *      Game after game, row after row, one GameEngine::CellType per cell.
+         */
+        static size_t GetObservationSize(size_t count, int width, int height);
+
+        /**
+         * @brief Start every game.
+         *
+         * @param count Games, at least one.
+         * @param width Same limits as GameEngine.
+         * @param height
+         * @param seed Game i starts episode k with seed + i + k*count.
+         * @param observations GetObservationSize bytes, kept up to date until the environment is gone.
+         */
+        VecEnv(size_t count, int width, int height, uint64_t seed, std::span<uint8_t> observations);
+        ~VecEnv() = default;
+
+        VecEnv(const VecEnv& other) = delete;
+        VecEnv& operator=(const VecEnv& other) = delete;
+        VecEnv(VecEnv&& other) noexcept = delete;
+        VecEnv& operator=(VecEnv&& other) noexcept = delete;
+
+        /**
+         * @brief Step every game once.
+         *
+         * @param actions One per game. Turning back keeps the direction, like GameEngine::SetDirection.
+         * @param rewards One per game: 1 for food, -1 for a crash, 0 otherwise.
+         * @param dones One per game: 1 if the episode ended, its observation is the next episode.
+         */
+        void Step(std::span<const Action> actions, std::span<float> rewards, std::span<uint8_t> dones);
+        /** Start every game again, with the next episode seeds */
+        void Reset();
+
+        size_t GetCount() const;
+        int GetWidth() const;
+        int GetHeight() const;
+        /** Of the current episodes */
+        std::span<const uint32_t> GetScores() const;
+        std::span<const uint32_t> GetLengths() const;
+        std::span<const uint32_t> GetTicks() const;
+
+    private:
+        static constexpr uint32_t NOT_IN_POOL = UINT32_MAX;
+        static constexpr uint32_t START_LENGTH = 4;
+        static constexpr int START_X = 5;
+
+        size_t _count;
+        int _width;
+        int _height;
+        uint32_t _size;
+        uint64_t _seed;
+        /** The caller's buffer, _size cells per game */
+        uint8_t* _cells;
+
+        /** Per game */
+        std::vector<uint8_t> _direction{};
+        std::vector<int32_t> _headX{};
+        std::vector<int32_t> _headY{};
+        /** Where the head is in the game's part of _body */
+        std::vector<uint32_t> _headSlot{};
+        std::vector<uint32_t> _length{};
+        std::vector<uint32_t> _score{};
+        std::vector<uint32_t> _tick{};
+        std::vector<uint32_t> _episode{};
+        std::vector<Random> _rng{};
+        std::vector<uint32_t> _poolSize{};
+        /** The cell the head moves into, found for every game before any is stepped */
+        std::vector<uint32_t> _next{};
+
+        /** _size per game */
+        /** The snake as a ring of cells, the head at _headSlot going forward */
+        std::vector<uint32_t> _body{};
+        /** Empty cells to draw the food from, in the order of GameEngine's pool */
+        std::vector<uint32_t> _pool{};
+        std::vector<uint32_t> _positions{};
+
+        void ResetGame(size_t game);
+        void Insert(size_t game, uint32_t cell);
+        void Remove(size_t game, uint32_t cell);
+        uint32_t PopRandom(size_t game);
+    };
+}
@@ -1,29 +1,202 @@
 #include <tev-cpp/Tev.h>
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <vector>
+#include <filesystem>
 #include <signal.h>
 #include "Console.h"
 #include "MainSession.h"
 #include "SignalManager.h"
+#include "SettingsService.h"
+#include "LeaderBoard.h"
+#include "ScoreVerifier.h"
+#include "Benchmark.h"
+#include "Tournament.h"
+#include "CompiledLevel.h"
+
+static int MergeLeaderBoards(int argc, char const *argv[])
+{
+    std::vector<std::filesystem::path> files{};
+    for (int i = 2; i < argc; i++)
+    {
+        files.emplace_back(argv[i]);
+    }
+    if (files.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " --merge-leaderboards <files...>" << std::endl;
+        return 1;
+    }
+    try
+    {
+        Snake::LeaderBoard::MergeScores(files, std::cout);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+static int VerifyLeaderBoard()
+{
+    try
+    {
+        return Snake::ScoreVerifier::VerifyLeaderBoard(std::cout) == 0 ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
+
+static int RunTournament(int argc, char const *argv[])
+{
+    Snake::Tournament::Options options{};
+    try
+    {
+        for (int i = 2; i < argc; i += 2)
+        {
+            std::string_view option{argv[i]};
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("Missing value for " + std::string{option});
+            }
+            std::string value{argv[i + 1]};
+            if (option == "--games")
+            {
+                options.games = static_cast<uint32_t>(std::stoul(value));
+            }
+            else if (option == "--size")
+            {
+                auto separator = value.find('x');
+                if (separator == std::string::npos)
+                {
+                    throw std::invalid_argument("Size must be WIDTHxHEIGHT");
+                }
+                options.boardWidth = std::stoi(value.substr(0, separator));
+                options.boardHeight = std::stoi(value.substr(separator + 1));
+            }
+            else if (option == "--threads")
+            {
+                options.threads = std::stoul(value);
+            }
+            else if (option == "--seed")
+            {
+                options.seed = std::stoull(value);
+            }
+            else if (option == "--csv")
+            {
+                options.csvPath = value;
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown option " + std::string{option});
+            }
+        }
+        Snake::Tournament::Run(options, std::cout);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << "Usage: " << argv[0]
+            << " --tournament [--games N] [--size WIDTHxHEIGHT] [--threads N] [--seed N] [--csv FILE]" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+static int CompileLevel(int argc, char const *argv[])
+{
+    if (argc != 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " --compile-level <input.level> <output"
+            << Snake::CompiledLevel::EXTENSION << ">" << std::endl;
+        return 1;
+    }
+    try
+    {
+        auto level = Snake::CompiledLevel::Compile(Snake::Level::Load(argv[2]));
+        /** A running game may have the old file mapped, it must never see it truncated */
+        std::filesystem::path path{argv[3]};
+        auto temporaryPath = path;
+        temporaryPath += ".tmp";
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (file.fail())
+        {
+            throw std::runtime_error("Failed to open compiled level file for writing");
+        }
+        level->Write(file);
+        file.close();
+        if (file.fail())
+        {
+            throw std::runtime_error("Failed to write compiled level file");
+        }
+        std::filesystem::rename(temporaryPath, path);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char const *argv[])
 {
-    (void)argc;
-    (void)argv;
+    if (argc > 1)
+    {
+        std::string_view mode{argv[1]};
+        if (mode == "--merge-leaderboards")
+        {
+            return MergeLeaderBoards(argc, argv);
+        }
+        if (mode == "--verify")
+        {
+            return VerifyLeaderBoard();
+        }
+        if (mode == "--benchmark")
+        {
+            return Snake::Benchmark::Run(std::cout) ? 0 : 1;
+        }
+        if (mode == "--tournament")
+        {
+            return RunTournament(argc, argv);
+        }
+        if (mode == "--compile-level")
+        {
+            return CompileLevel(argc, argv);
+        }
+        std::cerr << "Usage: " << argv[0]
+            << " [--merge-leaderboards <files...> | --verify | --benchmark | --tournament ... | --compile-level ...]"
+            << std::endl;
+        return 1;
+    }
 
     Tev tev{};
 
     auto signalManager = Snake::SignalManager::GetSingleton(tev);
 
+    Snake::SettingsService settings{tev};
     Snake::Console console{tev};
-    Snake::MainSession mainSession{tev, console};
+    Snake::MainSession mainSession{tev, console, settings};
 
     auto closeApp = [&](){
         mainSession.Close();
+        settings.Close();
         console.Close();
         signalManager->Close();
     };
     signalManager->SetHandler(SIGINT, closeApp);
     signalManager->SetHandler(SIGTERM, closeApp);
+    signalManager->SetHandler(SIGHUP, closeApp);
+    signalManager->SetHandler(SIGWINCH, [&console](){
+        console.NotifyResize();
+    });
 
     mainSession.Activate(0, [&](const int& result){
         (void)result;